@@ -0,0 +1,119 @@
+#ifndef ADAPTIVE_TRAPEZOIDAL_H
+#define ADAPTIVE_TRAPEZOIDAL_H
+
+#include <atomic>
+#include <cmath>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <queue>
+#include <vector>
+#include "thread_pool.h"
+
+// One pending subinterval of an adaptive trapezoidal integral.
+// fc is the midpoint value and S the trapezoid estimate on [a, b].
+struct TrapezoidTask {
+    double a, b, tol, fa, fb, fc, S;
+};
+
+// Outcome of refining one TrapezoidTask: either an accepted value with
+// its error estimate, or two child tasks to refine further
+struct RefineResult {
+    bool converged;
+    double value;
+    double error;
+    TrapezoidTask left, right;
+};
+
+// Evaluates the end points and midpoint of [a, b] (3 evaluations)
+inline TrapezoidTask make_root_task(double a, double b, double tol, const std::function<double(double)> &func) {
+    double h = (b - a) / 2.0;
+    double fa = func(a);
+    double fb = func(b);
+    double fc = func(a + h);
+    return TrapezoidTask{a, b, tol, fa, fb, fc, (h / 2.0) * (fa + 2 * fc + fb)};
+}
+
+// Refines one task with the quarter points (2 evaluations)
+inline RefineResult refine_task(const TrapezoidTask &task, const std::function<double(double)> &func) {
+    double h = (task.b - task.a) / 2.0;
+    double fd = func(task.a + h / 2.0);
+    double fe = func(task.a + 3 * h / 2.0);
+    double S_left = (h / 2.0) * (task.fa + 2 * fd + task.fc);
+    double S_right = (h / 2.0) * (task.fc + 2 * fe + task.fb);
+    double S2 = S_left + S_right;
+
+    RefineResult r;
+    r.converged = std::abs(S2 - task.S) < 15 * task.tol;
+    r.value = S2 + (S2 - task.S) / 15;
+    r.error = std::abs(S2 - task.S) / 15;
+    r.left = TrapezoidTask{task.a, task.a + h, task.tol / 2.0, task.fa, task.fc, fd, S_left};
+    r.right = TrapezoidTask{task.a + h, task.b, task.tol / 2.0, task.fc, task.fb, fe, S_right};
+    return r;
+}
+
+// Sequential Adaptive Trapezoidal Integration
+inline double sequential_adaptive_trapezoidal(double a, double b, double tol, std::function<double(double)> func, std::atomic<int> &function_evals) {
+    std::function<double(const TrapezoidTask &)> integrate;
+
+    integrate = [&](const TrapezoidTask &task) -> double {
+        RefineResult r = refine_task(task, func);
+        function_evals += 2;
+        if (r.converged) {
+            return r.value;
+        } else {
+            return integrate(r.left) + integrate(r.right);
+        }
+    };
+
+    function_evals += 3;
+    return integrate(make_root_task(a, b, tol, func));
+}
+
+// Adaptive Trapezoidal Integration on num_workers pool threads (0: all of them)
+inline void adaptive_trapezoidal(double a, double b, double tol, std::function<double(double)> func, ThreadPool &pool, double &result, std::atomic<int> &function_evals, std::mutex &result_mutex, size_t num_workers = 0) {
+    std::queue<TrapezoidTask> task_queue;
+    std::mutex task_mutex;
+
+    task_queue.push(make_root_task(a, b, tol, func));
+    function_evals += 3;
+
+    auto worker = [&]() {
+        while (true) {
+            TrapezoidTask task;
+            {
+                std::lock_guard<std::mutex> lock(task_mutex);
+                if (task_queue.empty()) {
+                    return;
+                }
+                task = task_queue.front();
+                task_queue.pop();
+            }
+
+            RefineResult r = refine_task(task, func);
+            function_evals += 2;
+
+            if (r.converged) {
+                std::lock_guard<std::mutex> lock(result_mutex);
+                result += r.value;
+            } else {
+                std::lock_guard<std::mutex> lock(task_mutex);
+                task_queue.push(r.left);
+                task_queue.push(r.right);
+            }
+        }
+    };
+
+    if (num_workers == 0 || num_workers > pool.get_num_workers())
+        num_workers = pool.get_num_workers();
+    std::vector<std::future<void>> futures;
+    for (size_t i = 0; i < num_workers; ++i) {
+        futures.push_back(pool.enqueue(worker));
+    }
+
+    for (auto &future : futures) {
+        future.get();
+    }
+}
+
+#endif // ADAPTIVE_TRAPEZOIDAL_H
@@ -0,0 +1,52 @@
+#ifndef ASYNC_INTEGRATION_H
+#define ASYNC_INTEGRATION_H
+
+// Coroutine versions of the adaptive trapezoidal integrator. Requires C++20.
+
+#include <atomic>
+#include <functional>
+#include <utility>
+#include <vector>
+#include "adaptive_trapezoidal.h"
+#include "coro_task.h"
+#include "thread_pool.h"
+
+// Refines one task; while spawn_depth > 0 the two halves run in parallel
+// through when_all, below that the subtree is integrated sequentially.
+// Nothing ever blocks a pool thread: the parent suspends until both
+// halves are done and is resumed by whichever finishes last.
+// The tasks are lazy and may be awaited after the caller's temporaries are
+// gone, so func is taken by value and lives in the coroutine frame; only
+// 2^spawn_depth tasks are created, so the copies are cheap.
+inline Task<double> adaptive_trapezoidal_task(ThreadPool &pool, TrapezoidTask task, std::function<double(double)> func,
+                                              std::atomic<int> &function_evals, int spawn_depth) {
+    RefineResult r = refine_task(task, func);
+    function_evals += 2;
+    if (r.converged)
+        co_return r.value;
+
+    if (spawn_depth <= 0) {
+        std::function<double(const TrapezoidTask &)> integrate = [&](const TrapezoidTask &t) -> double {
+            RefineResult rr = refine_task(t, func);
+            function_evals += 2;
+            return rr.converged ? rr.value : integrate(rr.left) + integrate(rr.right);
+        };
+        co_return integrate(r.left) + integrate(r.right);
+    }
+
+    std::vector<Task<double>> halves;
+    halves.push_back(adaptive_trapezoidal_task(pool, r.left, func, function_evals, spawn_depth - 1));
+    halves.push_back(adaptive_trapezoidal_task(pool, r.right, func, function_evals, spawn_depth - 1));
+    std::vector<double> values = co_await when_all(pool, std::move(halves));
+    co_return values[0] + values[1];
+}
+
+// Awaitable adaptive trapezoidal integral of func over [a, b]
+inline Task<double> adaptive_trapezoidal_async(ThreadPool &pool, double a, double b, double tol, std::function<double(double)> func,
+                                               std::atomic<int> &function_evals, int spawn_depth = 4) {
+    TrapezoidTask root = make_root_task(a, b, tol, func);
+    function_evals += 3;
+    co_return co_await adaptive_trapezoidal_task(pool, root, func, function_evals, spawn_depth);
+}
+
+#endif // ASYNC_INTEGRATION_H
@@ -0,0 +1,155 @@
+#ifndef AUTOTUNE_H
+#define AUTOTUNE_H
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "thread_pool.h"
+
+// Half-open range of interval indices [begin, end)
+struct Range {
+    int begin, end;
+};
+
+// Splits n intervals into `parts` contiguous ranges. The first n % parts
+// ranges get one extra interval, so no interval is ever dropped.
+inline Range split_range(int n, int parts, int i) {
+    int base = n / parts;
+    int rem = n % parts;
+    int begin = i * base + std::min(i, rem);
+    return Range{begin, begin + base + (i < rem ? 1 : 0)};
+}
+
+// Parameters picked by the autotuner for one integrand and size class
+struct TuningParams {
+    int threads;       // Number of worker threads to use
+    int chunk;         // Intervals handed to a worker at a time
+    double eval_cost;  // Measured cost of one function evaluation (s)
+};
+
+// Picks thread count and chunk size from a short calibration run.
+// Results are persisted per (integrand, size class) in a plain text file,
+// one "name size_class threads chunk eval_cost" record per line.
+class Autotuner {
+public:
+    explicit Autotuner(const std::string &cache_file = "autotune.cache")
+        : cache_file(cache_file), dispatch_cost(-1.0) {
+        load();
+    }
+
+    // Size class of a problem: floor(log2(n))
+    static int size_class(int n) {
+        int c = 0;
+        while (n > 1) {
+            n >>= 1;
+            ++c;
+        }
+        return c;
+    }
+
+    TuningParams tune(const std::string &name, int n, const std::function<double(double)> &func,
+                      double a, double b) {
+        auto key = std::make_pair(name, size_class(n));
+        auto it = table.find(key);
+        if (it != table.end())
+            return it->second;
+
+        TuningParams params = calibrate(n, func, a, b);
+        table[key] = params;
+        save();
+        return params;
+    }
+
+private:
+    // Each worker must do at least this many dispatch costs worth of work,
+    // otherwise handing it a task is not worth it.
+    static constexpr double min_work_per_dispatch = 10.0;
+    // Chunks per thread, so that uneven evaluation costs still balance
+    static constexpr int chunks_per_thread = 4;
+
+    std::string cache_file;
+    std::map<std::pair<std::string, int>, TuningParams> table;
+    double dispatch_cost;
+
+    TuningParams calibrate(int n, const std::function<double(double)> &func, double a, double b) {
+        double cost = measure_eval_cost(func, a, b);
+        double dispatch = measure_dispatch_cost();
+
+        int hw = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        double total_work = n * cost;
+        int threads = static_cast<int>(total_work / (min_work_per_dispatch * dispatch));
+        threads = std::max(1, std::min(hw, threads));
+
+        // A chunk should cost at least one dispatch, but there should still be
+        // several chunks per thread to absorb imbalance.
+        int min_chunk = static_cast<int>(std::ceil(dispatch / std::max(cost, 1e-12)));
+        int chunk = (n + threads * chunks_per_thread - 1) / (threads * chunks_per_thread);
+        chunk = std::max(1, std::min(n, std::max(chunk, min_chunk)));
+
+        return TuningParams{threads, chunk, cost};
+    }
+
+    // Evaluates the integrand on a spread of points until ~1ms has elapsed
+    static double measure_eval_cost(const std::function<double(double)> &func, double a, double b) {
+        const int batch = 256;
+        volatile double sink = 0.0;
+        long evals = 0;
+        auto start = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> elapsed(0);
+        while (elapsed.count() < 1e-3) {
+            for (int i = 0; i < batch; ++i)
+                sink = sink + func(a + (b - a) * (i + 0.5) / batch);
+            evals += batch;
+            elapsed = std::chrono::high_resolution_clock::now() - start;
+        }
+        return elapsed.count() / evals;
+    }
+
+    // Median round trip of an empty task through the persistent pool, measured once
+    double measure_dispatch_cost() {
+        if (dispatch_cost > 0)
+            return dispatch_cost;
+        ThreadPool &pool = persistent_pool(1);
+        std::vector<double> samples;
+        for (int i = 0; i < 9; ++i) {
+            auto start = std::chrono::high_resolution_clock::now();
+            pool.enqueue([] {}).get();
+            std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+            samples.push_back(elapsed.count());
+        }
+        std::nth_element(samples.begin(), samples.begin() + samples.size() / 2, samples.end());
+        dispatch_cost = samples[samples.size() / 2];
+        return dispatch_cost;
+    }
+
+    void load() {
+        std::ifstream in(cache_file);
+        std::string line;
+        while (std::getline(in, line)) {
+            std::istringstream fields(line);
+            std::string name;
+            int cls;
+            TuningParams params;
+            if (fields >> name >> cls >> params.threads >> params.chunk >> params.eval_cost)
+                table[std::make_pair(name, cls)] = params;
+        }
+    }
+
+    void save() const {
+        std::ofstream out(cache_file);
+        for (const auto &entry : table) {
+            out << entry.first.first << " " << entry.first.second << " " << entry.second.threads << " "
+                << entry.second.chunk << " " << entry.second.eval_cost << "\n";
+        }
+    }
+};
+
+#endif // AUTOTUNE_H
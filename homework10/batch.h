@@ -0,0 +1,189 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "adaptive_trapezoidal.h"
+#include "thread_pool.h"
+
+// One independent integral of a batch
+struct IntegrationJob {
+    std::function<double(double)> func;
+    double a, b, tol;
+};
+
+// Per-job output of integrate_batch
+struct JobResult {
+    double value;           // Integral estimate
+    double error_estimate;  // Sum of the Richardson error estimates of the accepted pieces
+    long evals;             // Function evaluations spent on this job
+};
+
+// Aggregate statistics of one integrate_batch call
+struct BatchStats {
+    double seconds;
+    double integrals_per_second;
+    long total_evals;
+    long steals;  // Work items taken from another worker's deque
+};
+
+// Runs every job on the pool. Each worker owns a deque of work items:
+// it pops the newest item from its own back (depth first, cache friendly)
+// and, when empty, steals the oldest item from another worker's front.
+// Unstarted jobs and subintervals of running jobs are both work items, so
+// stealing balances load across jobs and within a single expensive job.
+// num_workers limits how many pool threads take part (0: all of them).
+inline std::vector<JobResult> integrate_batch(const std::vector<IntegrationJob> &jobs, ThreadPool &pool,
+                                              BatchStats *stats = nullptr, size_t num_workers = 0) {
+    struct WorkItem {
+        size_t job;
+        bool started;  // false: the root of the job still has to be evaluated
+        TrapezoidTask task;
+    };
+    struct WorkerDeque {
+        std::mutex mutex;
+        std::deque<WorkItem> items;
+        std::atomic<size_t> size{0};  // items.size(), readable without the lock
+    };
+    struct JobAccumulator {
+        std::atomic<double> value{0.0};
+        std::atomic<double> error{0.0};
+        std::atomic<long> evals{0};
+    };
+
+    auto atomic_add = [](std::atomic<double> &target, double x) {
+        double old = target.load(std::memory_order_relaxed);
+        while (!target.compare_exchange_weak(old, old + x, std::memory_order_relaxed)) {
+        }
+    };
+
+    // Stealable items a worker keeps in its deque before splitting privately
+    const size_t publish_threshold = 4;
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    if (num_workers == 0 || num_workers > pool.get_num_workers())
+        num_workers = pool.get_num_workers();
+    std::unique_ptr<WorkerDeque[]> deques(new WorkerDeque[num_workers]);
+    std::unique_ptr<JobAccumulator[]> accum(new JobAccumulator[jobs.size()]);
+    std::atomic<long> outstanding(static_cast<long>(jobs.size()));
+    std::atomic<long> steals(0);
+
+    // Deal the unstarted jobs out round-robin
+    for (size_t j = 0; j < jobs.size(); ++j) {
+        deques[j % num_workers].items.push_back(WorkItem{j, false, TrapezoidTask()});
+        ++deques[j % num_workers].size;
+    }
+
+    auto pop_own = [&](size_t id, WorkItem &item) {
+        std::lock_guard<std::mutex> lock(deques[id].mutex);
+        if (deques[id].items.empty())
+            return false;
+        item = deques[id].items.back();
+        deques[id].items.pop_back();
+        --deques[id].size;
+        return true;
+    };
+
+    auto steal = [&](size_t id, WorkItem &item) {
+        for (size_t k = 1; k < num_workers; ++k) {
+            WorkerDeque &victim = deques[(id + k) % num_workers];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.items.empty()) {
+                item = victim.items.front();
+                victim.items.pop_front();
+                --victim.size;
+                ++steals;
+                return true;
+            }
+        }
+        return false;
+    };
+
+    auto worker = [&](size_t id) {
+        WorkItem item;
+        std::vector<TrapezoidTask> local;
+        while (outstanding.load() > 0) {
+            if (!pop_own(id, item) && !steal(id, item)) {
+                std::this_thread::yield();
+                continue;
+            }
+
+            const IntegrationJob &job = jobs[item.job];
+            long evals = 0;
+            if (!item.started) {
+                item.task = make_root_task(job.a, job.b, job.tol, job.func);
+                evals += 3;
+            }
+
+            // Descend into the left child directly. The right child is
+            // published for stealing only while this worker's deque is short;
+            // otherwise it stays on a private stack and costs no locking.
+            // Accepted pieces are summed locally and flushed once per item.
+            double value = 0.0, error = 0.0;
+            local.clear();
+            local.push_back(item.task);
+            while (!local.empty()) {
+                TrapezoidTask task = local.back();
+                local.pop_back();
+                for (;;) {
+                    RefineResult r = refine_task(task, job.func);
+                    evals += 2;
+                    if (r.converged) {
+                        value += r.value;
+                        error += r.error;
+                        break;
+                    }
+                    if (deques[id].size.load(std::memory_order_relaxed) < publish_threshold) {
+                        ++outstanding;
+                        std::lock_guard<std::mutex> lock(deques[id].mutex);
+                        deques[id].items.push_back(WorkItem{item.job, true, r.right});
+                        ++deques[id].size;
+                    } else {
+                        local.push_back(r.right);
+                    }
+                    task = r.left;
+                }
+            }
+
+            JobAccumulator &acc = accum[item.job];
+            atomic_add(acc.value, value);
+            atomic_add(acc.error, error);
+            acc.evals += evals;
+            --outstanding;
+        }
+    };
+
+    std::vector<std::future<void>> futures;
+    for (size_t i = 0; i < num_workers; ++i) {
+        futures.push_back(pool.enqueue([&worker, i]() { worker(i); }));
+    }
+    for (auto &future : futures) {
+        future.get();
+    }
+
+    std::vector<JobResult> results(jobs.size());
+    long total_evals = 0;
+    for (size_t j = 0; j < jobs.size(); ++j) {
+        results[j] = JobResult{accum[j].value.load(), accum[j].error.load(), accum[j].evals.load()};
+        total_evals += results[j].evals;
+    }
+
+    if (stats) {
+        std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start_time;
+        stats->seconds = elapsed.count();
+        stats->integrals_per_second = jobs.size() / elapsed.count();
+        stats->total_evals = total_evals;
+        stats->steals = steals.load();
+    }
+    return results;
+}
+
+#endif // BATCH_H
@@ -0,0 +1,59 @@
+#include <iostream>
+#include <vector>
+#include <functional>
+#include <chrono>
+#include <cmath>
+#include <atomic>
+#include "batch.h"
+#include "thread_pool.h"
+
+// Family of integrands, one per parameter set: sqrt(x) * (1 - x)^p
+std::function<double(double)> make_integrand(double p) {
+    return [p](double x) { return std::sqrt(x) * std::pow(1 - x, p); };
+}
+
+int main(int argc, char **argv) {
+    AffinityConfig affinity = parse_affinity_args(argc, argv);
+    const int num_jobs = 10000;
+    const double tol = 1e-8;
+    std::vector<int> thread_counts = {1, 2, 4, 8, 16};
+
+    std::vector<IntegrationJob> jobs;
+    for (int j = 0; j < num_jobs; ++j) {
+        double p = 1.0 + 3.0 * j / num_jobs;
+        jobs.push_back(IntegrationJob{make_integrand(p), 0.0, 1.0, tol});
+    }
+
+    // Sequential reference: one job after the other on the calling thread
+    std::vector<double> reference(num_jobs);
+    std::atomic<int> seq_evals(0);
+    auto start_time = std::chrono::high_resolution_clock::now();
+    for (int j = 0; j < num_jobs; ++j)
+        reference[j] = sequential_adaptive_trapezoidal(jobs[j].a, jobs[j].b, jobs[j].tol, jobs[j].func, seq_evals);
+    std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start_time;
+    std::cout << "jobs: " << num_jobs << ", tol: " << tol << ", sequential: " << num_jobs / elapsed.count()
+              << " integrals/s, function evaluations: " << seq_evals.load() << std::endl;
+
+    for (int t : thread_counts) {
+        ThreadPool &pool = persistent_pool(t, affinity);
+        std::cout << "topology: " << pool.describe() << std::endl;
+
+        BatchStats stats;
+        std::vector<JobResult> results = integrate_batch(jobs, pool, &stats, t);
+
+        double max_diff = 0.0, max_error_estimate = 0.0;
+        for (int j = 0; j < num_jobs; ++j) {
+            max_diff = std::max(max_diff, std::abs(results[j].value - reference[j]));
+            max_error_estimate = std::max(max_error_estimate, results[j].error_estimate);
+        }
+
+        std::cout << "threads: " << t << ", time: " << stats.seconds << "s"
+                  << ", throughput: " << stats.integrals_per_second << " integrals/s"
+                  << ", function evaluations: " << stats.total_evals
+                  << ", steals: " << stats.steals
+                  << ", max error estimate: " << max_error_estimate
+                  << ", max diff vs sequential: " << max_diff << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,132 @@
+#include <iostream>
+#include <vector>
+#include <functional>
+#include <chrono>
+#include <cmath>
+#include <atomic>
+#include <future>
+#include "adaptive_trapezoidal.h"
+#include "async_integration.h"
+#include "coro_task.h"
+#include "thread_pool.h"
+
+// Function to be integrated
+auto f = [](double x) { return std::sqrt(x) * (1 - x) * (1 - x); };
+
+// Each link of a chain integrates f over [0, b] split into `pieces`
+// subranges, and the next link's b depends on this link's result.
+const int chain_depth = 50;
+const int pieces = 8;
+const double tol = 1e-9;
+
+double next_bound(double integral) { return 0.5 + integral; }
+
+// Integrates one piece sequentially and records the time spent computing
+double timed_piece(double a, double b, std::atomic<int> &evals, std::atomic<long> &busy_ns) {
+    auto start = std::chrono::high_resolution_clock::now();
+    double value = sequential_adaptive_trapezoidal(a, b, tol / pieces, f, evals);
+    auto end = std::chrono::high_resolution_clock::now();
+    busy_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    return value;
+}
+
+// Blocking chain: runs on a pool thread and waits on futures for every link
+double blocking_chain(ThreadPool &pool, std::atomic<int> &evals, std::atomic<long> &busy_ns) {
+    double b = 1.0, integral = 0.0;
+    for (int k = 0; k < chain_depth; ++k) {
+        std::vector<std::future<double>> futures;
+        for (int p = 0; p < pieces; ++p) {
+            double lo = b * p / pieces, hi = b * (p + 1) / pieces;
+            futures.push_back(pool.enqueue([=, &evals, &busy_ns]() { return timed_piece(lo, hi, evals, busy_ns); }));
+        }
+        integral = 0.0;
+        for (auto &fut : futures)
+            integral += fut.get();  // Blocks this pool thread
+        b = next_bound(integral);
+    }
+    return integral;
+}
+
+Task<double> piece_task(double a, double b, std::atomic<int> &evals, std::atomic<long> &busy_ns) {
+    co_return timed_piece(a, b, evals, busy_ns);
+}
+
+// Coroutine chain: suspends on every link instead of blocking
+Task<double> coroutine_chain(ThreadPool &pool, std::atomic<int> &evals, std::atomic<long> &busy_ns) {
+    co_await schedule_on(pool);
+    double b = 1.0, integral = 0.0;
+    for (int k = 0; k < chain_depth; ++k) {
+        std::vector<Task<double>> tasks;
+        for (int p = 0; p < pieces; ++p)
+            tasks.push_back(piece_task(b * p / pieces, b * (p + 1) / pieces, evals, busy_ns));
+        std::vector<double> values = co_await when_all(pool, std::move(tasks));
+        integral = 0.0;
+        for (double v : values)
+            integral += v;
+        b = next_bound(integral);
+    }
+    co_return integral;
+}
+
+Task<std::vector<double>> all_chains(ThreadPool &pool, int chains, std::atomic<int> &evals, std::atomic<long> &busy_ns) {
+    std::vector<Task<double>> tasks;
+    for (int c = 0; c < chains; ++c)
+        tasks.push_back(coroutine_chain(pool, evals, busy_ns));
+    co_return co_await when_all(pool, std::move(tasks));
+}
+
+int main() {
+    std::vector<int> thread_counts = {1, 2, 4, 8, 16};
+
+    std::cout << "Dependency chains: depth " << chain_depth << ", " << pieces << " parallel pieces per link, tol " << tol << std::endl;
+    for (int t : thread_counts) {
+        int chains = t;
+
+        // Blocking futures: every chain pins a pool thread while it waits,
+        // so the pool needs t extra threads or it deadlocks. The comparison
+        // needs pools of exactly these sizes, so these are not the shared
+        // persistent pool, which may hold more workers.
+        {
+            ThreadPool pool(t + chains);
+            std::atomic<int> evals(0);
+            std::atomic<long> busy_ns(0);
+            auto start = std::chrono::high_resolution_clock::now();
+            std::vector<std::future<double>> futures;
+            for (int c = 0; c < chains; ++c)
+                futures.push_back(pool.enqueue([&]() { return blocking_chain(pool, evals, busy_ns); }));
+            double result = 0.0;
+            for (auto &fut : futures)
+                result = fut.get();
+            std::chrono::duration<double> wall = std::chrono::high_resolution_clock::now() - start;
+            double utilization = 1e-9 * busy_ns.load() / (wall.count() * pool.get_num_workers());
+            std::cout << "blocking,  threads: " << pool.get_num_workers() << " (" << chains << " blocked)"
+                      << ", chains: " << chains << ", result: " << result << ", time: " << wall.count() << "s"
+                      << ", function evaluations: " << evals.load() << ", utilization: " << 100 * utilization << "%" << std::endl;
+        }
+
+        // Coroutines: chains suspend while their pieces run
+        {
+            ThreadPool pool(t);
+            std::atomic<int> evals(0);
+            std::atomic<long> busy_ns(0);
+            auto start = std::chrono::high_resolution_clock::now();
+            std::vector<double> results = sync_wait(all_chains(pool, chains, evals, busy_ns));
+            std::chrono::duration<double> wall = std::chrono::high_resolution_clock::now() - start;
+            double utilization = 1e-9 * busy_ns.load() / (wall.count() * pool.get_num_workers());
+            std::cout << "coroutine, threads: " << pool.get_num_workers() << " (0 blocked)"
+                      << ", chains: " << chains << ", result: " << results.back() << ", time: " << wall.count() << "s"
+                      << ", function evaluations: " << evals.load() << ", utilization: " << 100 * utilization << "%" << std::endl;
+        }
+
+        // Single nested integral through the async API, for comparison with part2
+        {
+            ThreadPool pool(t);
+            std::atomic<int> evals(0);
+            double result = sync_wait(adaptive_trapezoidal_async(pool, 0.0, 1.0, 1e-6, f, evals));
+            std::cout << "async adaptive_trapezoidal, threads: " << t << ", integral: " << result
+                      << ", function evaluations: " << evals.load() << std::endl;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,90 @@
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <functional>
+#include <chrono>
+#include <cmath>
+#include <future>
+#include "autotune.h"
+#include "thread_pool.h"
+
+// Function to be integrated
+auto f = [](double x) { return x * x * x - 3 * x * x + 2; };
+
+// Trapezoidal Integration over a range [a, b] with n intervals
+double trapezoidal(double a, double b, int n, const std::function<double(double)> &func) {
+    double h = (b - a) / n;
+    double result = 0.5 * (func(a) + func(b));
+    for (int i = 1; i < n; ++i) {
+        result += func(a + i * h);
+    }
+    return result * h;
+}
+
+// One small integral split over t tasks on the persistent pool
+double pooled_integral(double a, double b, int n, int t, const AffinityConfig &affinity) {
+    ThreadPool &pool = persistent_pool(t, affinity);
+    double h = (b - a) / n;
+    std::vector<std::future<double>> futures;
+    for (int i = 0; i < t; ++i) {
+        Range r = split_range(n, t, i);
+        double local_a = a + r.begin * h, local_b = a + r.end * h;
+        int local_n = r.end - r.begin;
+        futures.push_back(pool.enqueue([=]() { return trapezoidal(local_a, local_b, local_n, f); }));
+    }
+    double result = 0.0;
+    for (auto &fut : futures)
+        result += fut.get();
+    return result;
+}
+
+// The same integral with t freshly spawned threads, as part4 used to do
+double spawned_integral(double a, double b, int n, int t) {
+    double h = (b - a) / n;
+    std::vector<double> partial(t, 0.0);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < t; ++i) {
+        Range r = split_range(n, t, i);
+        threads.emplace_back([&, i, r]() { partial[i] = trapezoidal(a + r.begin * h, a + r.end * h, r.end - r.begin, f); });
+    }
+    for (auto &th : threads)
+        th.join();
+    double result = 0.0;
+    for (double p : partial)
+        result += p;
+    return result;
+}
+
+// Average latency per integral in microseconds
+template <class F>
+double latency_us(int reps, F &&integral) {
+    volatile double sink = 0.0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int r = 0; r < reps; ++r)
+        sink = sink + integral();
+    std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+    return 1e6 * elapsed.count() / reps;
+}
+
+int main(int argc, char **argv) {
+    AffinityConfig affinity = parse_affinity_args(argc, argv);
+    double a = 0.0, b = 2.0;
+    const int n = 1000;
+    const int pooled_reps = 100000;
+    const int spawned_reps = 1000;  // Spawning is slow enough that fewer reps suffice
+    std::vector<int> thread_counts = {1, 2, 4, 8, 16};
+
+    std::cout << "Latency of many tiny integrals (n = " << n << ")" << std::endl;
+    for (int t : thread_counts) {
+        pooled_integral(a, b, n, t, affinity);  // Warm up: creates the pool outside the timing
+        std::cout << "topology: " << persistent_pool(t, affinity).describe() << std::endl;
+        double pooled = latency_us(pooled_reps, [&] { return pooled_integral(a, b, n, t, affinity); });
+        double spawned = latency_us(spawned_reps, [&] { return spawned_integral(a, b, n, t); });
+        std::cout << "threads: " << t
+                  << ", persistent pool: " << pooled << " us/integral (" << pooled_reps << " integrals)"
+                  << ", fresh threads: " << spawned << " us/integral (" << spawned_reps << " integrals)"
+                  << ", speedup: " << spawned / pooled << "x" << std::endl;
+    }
+
+    return 0;
+}
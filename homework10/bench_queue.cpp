@@ -0,0 +1,123 @@
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <functional>
+#include <chrono>
+#include <atomic>
+#include <mutex>
+#include <queue>
+#include <new>
+#include <cstdlib>
+#include "inline_task.h"
+#include "mpmc_queue.h"
+
+// Counts heap allocations, to show which submission path allocates.
+// GCC cannot tell that these replace the global operators as a pair.
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+static std::atomic<long> allocations(0);
+
+void *operator new(std::size_t size) {
+    ++allocations;
+    if (void *p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+
+// The ThreadPool's previous design: std::function in a mutex-guarded std::queue
+struct LockedQueue {
+    std::mutex mutex;
+    std::queue<std::function<void()>> tasks;
+
+    bool try_push(std::function<void()> &&task) {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push(std::move(task));
+        return true;
+    }
+
+    bool try_pop(std::function<void()> &task) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (tasks.empty())
+            return false;
+        task = std::move(tasks.front());
+        tasks.pop();
+        return true;
+    }
+};
+
+struct RunStats {
+    double tasks_per_second;
+    double allocations_per_task;
+};
+
+// Producers push total_tasks small closures, consumers pop and run them
+template<class Queue, class Task>
+RunStats run(Queue &queue, int producers, int consumers, long total_tasks) {
+    std::atomic<long> sum(0);
+    std::atomic<long> done(0);
+    std::atomic<bool> go(false);
+    std::vector<std::thread> threads;
+
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p]() {
+            while (!go.load())
+                std::this_thread::yield();
+            for (long i = p; i < total_tasks; i += producers) {
+                Task task([&sum, i]() { sum.fetch_add(i, std::memory_order_relaxed); });
+                while (!queue.try_push(std::move(task)))
+                    std::this_thread::yield();
+            }
+        });
+    }
+    for (int c = 0; c < consumers; ++c) {
+        threads.emplace_back([&]() {
+            while (!go.load())
+                std::this_thread::yield();
+            Task task;
+            while (done.load(std::memory_order_relaxed) < total_tasks) {
+                if (queue.try_pop(task)) {
+                    task();
+                    ++done;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    long allocations_before = allocations.load();
+    auto start = std::chrono::high_resolution_clock::now();
+    go = true;
+    for (auto &th : threads)
+        th.join();
+    std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+    long allocated = allocations.load() - allocations_before;
+
+    if (sum.load() != total_tasks * (total_tasks - 1) / 2)
+        std::cerr << "lost tasks!" << std::endl;
+    return RunStats{total_tasks / elapsed.count(), static_cast<double>(allocated) / total_tasks};
+}
+
+int main() {
+    const long total_tasks = 200000;
+    std::vector<int> thread_counts = {1, 2, 4, 8, 16, 32};
+
+    std::cout << "Task queue throughput, " << total_tasks << " tasks per run" << std::endl;
+    for (int producers : thread_counts) {
+        for (int consumers : thread_counts) {
+            MpmcQueue<InlineTask> ring(4096);
+            RunStats lock_free = run<MpmcQueue<InlineTask>, InlineTask>(ring, producers, consumers, total_tasks);
+            LockedQueue locked;
+            RunStats mutex_queue = run<LockedQueue, std::function<void()>>(locked, producers, consumers, total_tasks);
+
+            std::cout << "producers: " << producers << ", consumers: " << consumers
+                      << ", mpmc ring: " << lock_free.tasks_per_second << " tasks/s (" << lock_free.allocations_per_task << " allocs/task)"
+                      << ", mutex queue: " << mutex_queue.tasks_per_second << " tasks/s (" << mutex_queue.allocations_per_task << " allocs/task)"
+                      << std::endl;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,195 @@
+#ifndef CORO_TASK_H
+#define CORO_TASK_H
+
+// Coroutine tasks scheduled on a ThreadPool. Requires C++20 (-std=c++20).
+//
+// A Task<T> is lazy: it starts when awaited and resumes its awaiter when
+// it finishes (symmetric transfer, no thread is blocked). schedule_on()
+// moves the current coroutine onto a pool worker, and when_all() runs
+// several tasks in parallel, suspending the caller until all are done.
+
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+#include "thread_pool.h"
+
+template<class T>
+class Task;
+
+namespace detail {
+
+// Resumes whoever awaited the finished task
+struct FinalAwaiter {
+    bool await_ready() noexcept { return false; }
+    template<class P>
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<P> h) noexcept {
+        std::coroutine_handle<> continuation = h.promise().continuation;
+        return continuation ? continuation : std::noop_coroutine();
+    }
+    void await_resume() noexcept {}
+};
+
+struct PromiseBase {
+    std::coroutine_handle<> continuation;
+    std::exception_ptr exception;
+
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    FinalAwaiter final_suspend() noexcept { return {}; }
+    void unhandled_exception() { exception = std::current_exception(); }
+};
+
+// Eager coroutine that owns and destroys its own frame
+struct Detached {
+    struct promise_type {
+        Detached get_return_object() { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+} // namespace detail
+
+template<class T>
+class Task {
+public:
+    struct promise_type : detail::PromiseBase {
+        std::optional<T> value;
+
+        Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        void return_value(T v) { value = std::move(v); }
+    };
+
+    Task(Task &&other) noexcept : handle(std::exchange(other.handle, {})) {}
+    Task &operator=(Task &&other) noexcept {
+        if (this != &other) {
+            if (handle)
+                handle.destroy();
+            handle = std::exchange(other.handle, {});
+        }
+        return *this;
+    }
+    Task(const Task &) = delete;
+    Task &operator=(const Task &) = delete;
+    ~Task() {
+        if (handle)
+            handle.destroy();
+    }
+
+    // Awaiting a task starts it and suspends the awaiter until it is done
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiter) noexcept {
+        handle.promise().continuation = awaiter;
+        return handle;
+    }
+    T await_resume() {
+        if (handle.promise().exception)
+            std::rethrow_exception(handle.promise().exception);
+        return std::move(*handle.promise().value);
+    }
+
+private:
+    explicit Task(std::coroutine_handle<promise_type> h) : handle(h) {}
+    std::coroutine_handle<promise_type> handle;
+};
+
+// co_await schedule_on(pool) continues the coroutine on a pool worker
+inline auto schedule_on(ThreadPool &pool) {
+    struct Awaiter {
+        ThreadPool &pool;
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> h) { pool.post([h]() { h.resume(); }); }
+        void await_resume() const noexcept {}
+    };
+    return Awaiter{pool};
+}
+
+namespace detail {
+
+template<class T>
+struct WhenAllState {
+    // One count per child plus one for the awaiter itself, so the awaiter
+    // can tell whether everything finished before it suspended
+    std::atomic<size_t> remaining;
+    std::vector<std::optional<T>> results;
+    std::exception_ptr exception;
+    std::mutex exception_mutex;
+    std::coroutine_handle<> continuation;
+};
+
+template<class T>
+Detached run_when_all_child(ThreadPool *pool, Task<T> task, WhenAllState<T> *state, size_t i) {
+    if (pool)
+        co_await schedule_on(*pool);
+    try {
+        state->results[i] = co_await task;
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(state->exception_mutex);
+        if (!state->exception)
+            state->exception = std::current_exception();
+    }
+    if (state->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        state->continuation.resume();
+}
+
+template<class T>
+Detached run_sync_wait(Task<T> task, std::promise<T> *result) {
+    try {
+        result->set_value(co_await task);
+    } catch (...) {
+        result->set_exception(std::current_exception());
+    }
+}
+
+} // namespace detail
+
+// Runs all tasks in parallel on the pool and resumes the awaiter with their
+// results, in order. The last task runs inline on the awaiting thread.
+template<class T>
+auto when_all(ThreadPool &pool, std::vector<Task<T>> tasks) {
+    struct Awaiter {
+        ThreadPool &pool;
+        std::vector<Task<T>> tasks;
+        detail::WhenAllState<T> state;
+
+        bool await_ready() const noexcept { return tasks.empty(); }
+        bool await_suspend(std::coroutine_handle<> h) {
+            state.continuation = h;
+            state.results.resize(tasks.size());
+            state.remaining.store(tasks.size() + 1);
+            for (size_t i = 0; i < tasks.size(); ++i) {
+                bool last = (i + 1 == tasks.size());
+                detail::run_when_all_child(last ? nullptr : &pool, std::move(tasks[i]), &state, i);
+            }
+            // Still suspended unless every child already finished
+            return state.remaining.fetch_sub(1, std::memory_order_acq_rel) != 1;
+        }
+        std::vector<T> await_resume() {
+            if (state.exception)
+                std::rethrow_exception(state.exception);
+            std::vector<T> values;
+            values.reserve(state.results.size());
+            for (auto &r : state.results)
+                values.push_back(std::move(*r));
+            return values;
+        }
+    };
+    return Awaiter{pool, std::move(tasks), {}};
+}
+
+// Blocks the calling (non-pool) thread until the task has finished
+template<class T>
+T sync_wait(Task<T> task) {
+    std::promise<T> result;
+    std::future<T> done = result.get_future();
+    detail::run_sync_wait(std::move(task), &result);
+    return done.get();
+}
+
+#endif // CORO_TASK_H
@@ -0,0 +1,24 @@
+#ifndef DOUBLE_DOUBLE_H
+#define DOUBLE_DOUBLE_H
+
+// Running sum kept as an unevaluated pair hi + lo (about 106 bits), updated
+// with Knuth's two-sum, so adding n terms costs no rounding error beyond
+// the final conversion to double. Do not build with -ffast-math, which
+// removes the error term.
+struct DoubleDoubleSum {
+    double hi = 0.0;
+    double lo = 0.0;
+
+    void add(double v) {
+        double s = hi + v;
+        double bv = s - hi;
+        double err = (hi - (s - bv)) + (v - bv);
+        lo += err;
+        // Renormalise so lo stays below one ulp of hi
+        hi = s + lo;
+        lo -= hi - s;
+    }
+    double value() const { return hi + lo; }
+};
+
+#endif
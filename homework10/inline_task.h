@@ -0,0 +1,99 @@
+#ifndef INLINE_TASK_H
+#define INLINE_TASK_H
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Move-only void() callable with small-buffer storage. Closures up to
+// inline_size bytes are stored in place, so wrapping them never touches
+// the heap; larger ones fall back to a single allocation.
+class InlineTask {
+public:
+    static constexpr size_t inline_size = 48;
+
+    InlineTask() noexcept : ops(nullptr) {}
+
+    template<class F, class D = typename std::decay<F>::type,
+             class = typename std::enable_if<!std::is_same<D, InlineTask>::value>::type>
+    InlineTask(F &&f) : ops(&ops_for<D>::table) {
+        if (stored_inline<D>())
+            new (&storage) D(std::forward<F>(f));
+        else
+            *reinterpret_cast<D **>(&storage) = new D(std::forward<F>(f));
+    }
+
+    InlineTask(InlineTask &&other) noexcept : ops(other.ops) {
+        if (ops)
+            ops->move(&other.storage, &storage);
+        other.ops = nullptr;
+    }
+
+    InlineTask &operator=(InlineTask &&other) noexcept {
+        if (this != &other) {
+            reset();
+            ops = other.ops;
+            if (ops)
+                ops->move(&other.storage, &storage);
+            other.ops = nullptr;
+        }
+        return *this;
+    }
+
+    InlineTask(const InlineTask &) = delete;
+    InlineTask &operator=(const InlineTask &) = delete;
+
+    ~InlineTask() { reset(); }
+
+    explicit operator bool() const noexcept { return ops != nullptr; }
+
+    void operator()() { ops->invoke(&storage); }
+
+    // True when a callable of type F is stored without allocating
+    template<class F>
+    static constexpr bool stored_inline() {
+        return sizeof(F) <= inline_size && alignof(F) <= alignof(std::max_align_t) &&
+               std::is_nothrow_move_constructible<F>::value;
+    }
+
+private:
+    struct Ops {
+        void (*invoke)(void *);
+        void (*move)(void *from, void *to);  // Move-constructs into `to` and destroys `from`
+        void (*destroy)(void *);
+    };
+
+    template<class D, bool Inline = stored_inline<D>()>
+    struct ops_for;
+
+    template<class D>
+    struct ops_for<D, true> {
+        static void invoke(void *p) { (*static_cast<D *>(p))(); }
+        static void move(void *from, void *to) {
+            new (to) D(std::move(*static_cast<D *>(from)));
+            static_cast<D *>(from)->~D();
+        }
+        static void destroy(void *p) { static_cast<D *>(p)->~D(); }
+        static constexpr Ops table = {invoke, move, destroy};
+    };
+
+    template<class D>
+    struct ops_for<D, false> {
+        static void invoke(void *p) { (**static_cast<D **>(p))(); }
+        static void move(void *from, void *to) { *static_cast<D **>(to) = *static_cast<D **>(from); }
+        static void destroy(void *p) { delete *static_cast<D **>(p); }
+        static constexpr Ops table = {invoke, move, destroy};
+    };
+
+    void reset() noexcept {
+        if (ops)
+            ops->destroy(&storage);
+        ops = nullptr;
+    }
+
+    const Ops *ops;
+    typename std::aligned_storage<inline_size, alignof(std::max_align_t)>::type storage;
+};
+
+#endif // INLINE_TASK_H
@@ -0,0 +1,99 @@
+#ifndef MPMC_QUEUE_H
+#define MPMC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+// Bounded multi-producer multi-consumer queue (Dmitry Vyukov's design).
+// Every cell carries a sequence number that tells producers and consumers
+// whether it is free or full for their lap around the ring, so push and
+// pop are a single CAS on the shared position plus one release store.
+template<class T>
+class MpmcQueue {
+public:
+    explicit MpmcQueue(size_t capacity) : buffer(new Cell[capacity]), mask(capacity - 1) {
+        if (capacity < 2 || (capacity & (capacity - 1)) != 0)
+            throw std::invalid_argument("MpmcQueue capacity must be a power of two");
+        for (size_t i = 0; i < capacity; ++i)
+            buffer[i].sequence.store(i, std::memory_order_relaxed);
+        enqueue_pos.store(0, std::memory_order_relaxed);
+        dequeue_pos.store(0, std::memory_order_relaxed);
+    }
+
+    ~MpmcQueue() {
+        T item;
+        while (try_pop(item)) {
+        }
+    }
+
+    MpmcQueue(const MpmcQueue &) = delete;
+    MpmcQueue &operator=(const MpmcQueue &) = delete;
+
+    // Returns false (and leaves value untouched) when the queue is full
+    bool try_push(T &&value) {
+        Cell *cell;
+        size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &buffer[pos & mask];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        new (&cell->storage) T(std::move(value));
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Returns false when the queue is empty
+    bool try_pop(T &value) {
+        Cell *cell;
+        size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &buffer[pos & mask];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = dequeue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        T *slot = reinterpret_cast<T *>(&cell->storage);
+        value = std::move(*slot);
+        slot->~T();
+        cell->sequence.store(pos + mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t capacity() const { return mask + 1; }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+    };
+
+    std::unique_ptr<Cell[]> buffer;
+    size_t mask;
+    // Producers and consumers hammer different positions; keep them on
+    // separate cache lines
+    alignas(64) std::atomic<size_t> enqueue_pos;
+    alignas(64) std::atomic<size_t> dequeue_pos;
+};
+
+#endif // MPMC_QUEUE_H
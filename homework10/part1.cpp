@@ -7,6 +7,7 @@
 #include <future>
 #include <atomic>
 #include <mutex>
+#include "autotune.h"
 
 // Function to be integrated
 auto f = [](double x) { return x * x * x - 3 * x * x + 2; };
@@ -29,11 +30,9 @@ void parallel_non_adaptive_trapezoidal(double a, double b, int n, int num_thread
         return local_result;
     };
 
-    int chunk_size = n / num_threads;
     for (int i = 0; i < num_threads; ++i) {
-        int start = i * chunk_size;
-        int end = (i == num_threads - 1) ? n : start + chunk_size;
-        futures.push_back(std::async(std::launch::async, worker, start, end));
+        Range r = split_range(n, num_threads, i);
+        futures.push_back(std::async(std::launch::async, worker, r.begin, r.end));
     }
 
     for (auto &fut : futures) {
@@ -6,18 +6,27 @@
 #include <cmath>
 #include <numeric>
 #include <mutex>
+#include <atomic>
+#include <future>
+#include "autotune.h"
+#include "thread_pool.h"
+#include "double_double.h"
 
 // Function to be integrated
 auto f = [](double x) { return x * x * x - 3 * x * x + 2; };
 
-// Trapezoidal Integration over a range [a, b] with n intervals
+// Trapezoidal Integration over a range [a, b] with n intervals, summed in
+// double-double so the reference adds no rounding error of its own to the
+// errors reported below
 double trapezoidal(double a, double b, int n, std::function<double(double)> func) {
     double h = (b - a) / n;
-    double result = 0.5 * (func(a) + func(b));
+    DoubleDoubleSum sum;
+    sum.add(0.5 * func(a));
+    sum.add(0.5 * func(b));
     for (int i = 1; i < n; ++i) {
-        result += func(a + i * h);
+        sum.add(func(a + i * h));
     }
-    return result * h;
+    return sum.value() * h;
 }
 
 // Threaded function to calculate the integral over a subinterval
@@ -30,10 +39,43 @@ double thread_trapezoidal(double a, double b, int n, std::function<double(double
     return result * h;
 }
 
-int main() {
+// Integration over [a, b] with n intervals, handed out in chunks of
+// params.chunk intervals to params.threads workers
+double chunked_trapezoidal(double a, double b, int n, std::function<double(double)> func, const TuningParams &params,
+                           const AffinityConfig &affinity) {
+    double h = (b - a) / n;
+    int num_chunks = (n + params.chunk - 1) / params.chunk;
+    std::atomic<int> next_chunk(0);
+    ThreadPool &pool = persistent_pool(params.threads, affinity);
+
+    auto worker = [&]() {
+        double local_result = 0.0;
+        for (int c = next_chunk++; c < num_chunks; c = next_chunk++) {
+            int start = c * params.chunk;
+            int end = std::min(n, start + params.chunk);
+            local_result += thread_trapezoidal(a + start * h, a + end * h, end - start, func);
+        }
+        return local_result;
+    };
+
+    std::vector<std::future<double>> futures;
+    for (int i = 0; i < params.threads; ++i) {
+        futures.push_back(pool.enqueue(worker));
+    }
+
+    double result = 0.0;
+    for (auto &fut : futures) {
+        result += fut.get();
+    }
+    return result;
+}
+
+int main(int argc, char **argv) {
+    AffinityConfig affinity = parse_affinity_args(argc, argv);
     double a = 0.0, b = 2.0;
     std::vector<int> n_values = {1000, 10000, 100000};
     std::vector<int> thread_counts = {1, 2, 4, 8, 16};
+    Autotuner tuner;
 
     // High-precision sequential integration as reference
     int high_precision_n = 1000000; // Using a large value for n to increase precision
@@ -42,27 +84,29 @@ int main() {
 
     for (int n : n_values) {
         for (int t : thread_counts) {
-            double h = (b - a) / t;
-            std::vector<std::thread> threads;
+            double h = (b - a) / n;
+            ThreadPool &pool = persistent_pool(t, affinity);
+            if (n == n_values.front())
+                std::cout << "topology: " << pool.describe() << std::endl;
+            std::vector<std::future<double>> futures;
             double total_result = 0.0;
-            std::mutex result_mutex;
 
             auto start_time = std::chrono::high_resolution_clock::now();
 
-            // Launch threads
+            // Submit one task per thread, each owning a contiguous range of intervals
             for (int i = 0; i < t; ++i) {
-                double local_a = a + i * h;
-                double local_b = local_a + h;
-                threads.emplace_back([&, local_a, local_b]() {
-                    double local_result = thread_trapezoidal(local_a, local_b, n / t, f);
-                    std::lock_guard<std::mutex> lock(result_mutex);
-                    total_result += local_result;
-                });
+                Range r = split_range(n, t, i);
+                double local_a = a + r.begin * h;
+                double local_b = a + r.end * h;
+                int local_n = r.end - r.begin;
+                futures.push_back(pool.enqueue([=]() {
+                    return thread_trapezoidal(local_a, local_b, local_n, f);
+                }));
             }
 
-            // Join threads
-            for (auto &th : threads) {
-                th.join();
+            // Collect partial results
+            for (auto &fut : futures) {
+                total_result += fut.get();
             }
 
             auto end_time = std::chrono::high_resolution_clock::now();
@@ -77,6 +121,17 @@ int main() {
                       << ", time: " << elapsed.count() << "s"
                       << ", error: " << error << std::endl;
         }
+
+        // Let the autotuner pick thread count and chunk size for this n
+        TuningParams params = tuner.tune("cubic", n, f, a, b);
+        auto start_time = std::chrono::high_resolution_clock::now();
+        double tuned_result = chunked_trapezoidal(a, b, n, f, params, affinity);
+        auto end_time = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> elapsed = end_time - start_time;
+        std::cout << "n: " << n << ", threads: " << params.threads << " (auto, chunk " << params.chunk << ")"
+                  << ", integral: " << tuned_result
+                  << ", time: " << elapsed.count() << "s"
+                  << ", error: " << fabs(tuned_result - high_precision_result) << std::endl;
         std::cout << std::endl;
     }
 
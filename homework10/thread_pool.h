@@ -0,0 +1,318 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "inline_task.h"
+#include "mpmc_queue.h"
+#include "topology.h"
+
+struct ThreadPool {
+    // Each NUMA node's queue is a bounded lock-free ring of this many tasks
+    static constexpr size_t queue_capacity = 4096;
+
+    // Idle workers poll the queue for spin_count rounds before blocking on
+    // the condition variable, so back-to-back submissions skip the wake-up.
+    explicit ThreadPool(size_t num_threads, int spin_count = 2000);
+    // Same, with workers pinned according to `affinity`
+    ThreadPool(size_t num_threads, const AffinityConfig &affinity, int spin_count = 2000);
+    ~ThreadPool();
+    // Queues f near the caller: on the caller's NUMA node when called from a
+    // pool worker, otherwise spread round-robin over the nodes in use.
+    template<class F>
+    auto enqueue(F&& f) -> std::future<typename std::result_of<F()>::type>;
+    // Queues f for the workers on NUMA node `node`. Workers on other nodes
+    // only take it once their own queue is empty.
+    template<class F>
+    auto enqueue_on_node(int node, F&& f) -> std::future<typename std::result_of<F()>::type>;
+    // Fire-and-forget variant of enqueue for callers that need no result,
+    // such as resuming a suspended coroutine. Closures that fit in an
+    // InlineTask are submitted without any heap allocation.
+    template<class F>
+    void post(F&& f);
+    // Starts more workers until there are at least num_threads, pinned as
+    // if the pool had been built with num_threads. A worker whose NUMA node
+    // has no queue yet shares the first queue. Not safe to call concurrently
+    // with itself or with describe().
+    void grow(size_t num_threads);
+    size_t get_num_workers() const;
+    // Distinct NUMA nodes among the workers (1 when unpinned)
+    size_t get_num_nodes() const;
+    // Describes the policy and the CPU each worker ended up on
+    std::string describe() const;
+
+private:
+    void start(size_t first, size_t last);
+    size_t home_queue();
+    template<class F>
+    auto submit(size_t queue, F&& f) -> std::future<typename std::result_of<F()>::type>;
+    void push_task(size_t queue, InlineTask task);
+    bool try_pop_task(size_t home, InlineTask &task);
+
+    std::vector<std::thread> workers;
+    std::atomic<size_t> num_workers;  // workers.size(), readable while the pool grows
+    Topology topology;
+    AffinityConfig affinity;
+    std::vector<int> worker_cpu;       // CPU of each worker, -1 when unpinned
+    std::vector<size_t> worker_queue;  // Queue of each worker's NUMA node
+    std::vector<int> queue_node;       // NUMA node served by each queue
+    std::vector<std::unique_ptr<MpmcQueue<InlineTask>>> tasks;
+    std::mutex queue_mutex;       // Only used to put idle workers to sleep
+    std::condition_variable condition;
+    std::atomic<size_t> pending;  // Tasks submitted but not yet popped
+    std::atomic<size_t> next_queue;
+    std::atomic<size_t> sleepers; // Workers blocked on condition
+    int spin_count;
+    std::atomic<bool> stop;
+    std::atomic<size_t> pinned;   // Workers whose pinning the OS accepted
+    std::atomic<size_t> started;  // Workers that finished pinning themselves
+};
+
+// Pool and queue of the worker running on this thread, if any
+inline const ThreadPool *&current_pool() {
+    static thread_local const ThreadPool *pool = nullptr;
+    return pool;
+}
+
+inline size_t &current_queue() {
+    static thread_local size_t queue = 0;
+    return queue;
+}
+
+inline ThreadPool::ThreadPool(size_t num_threads, int spin_count)
+    : ThreadPool(num_threads, AffinityConfig(), spin_count) {}
+
+inline ThreadPool::ThreadPool(size_t num_threads, const AffinityConfig &affinity, int spin_count)
+    : num_workers(0), affinity(affinity), pending(0), next_queue(0), sleepers(0), spin_count(spin_count), stop(false), pinned(0),
+      started(0) {
+    if (affinity.policy != PinPolicy::None)
+        topology = Topology::detect();
+    worker_cpu = select_cpus(topology, affinity, num_threads);
+
+    // One queue per NUMA node that has a worker on it
+    std::map<int, size_t> queue_of;
+    for (size_t i = 0; i < num_threads; ++i) {
+        const CpuInfo *info = worker_cpu[i] < 0 ? nullptr : topology.find(worker_cpu[i]);
+        int node = info ? info->node : 0;
+        if (!queue_of.count(node)) {
+            queue_of[node] = queue_node.size();
+            queue_node.push_back(node);
+        }
+        worker_queue.push_back(queue_of[node]);
+    }
+    if (queue_node.empty())
+        queue_node.push_back(0);
+    for (size_t q = 0; q < queue_node.size(); ++q)
+        tasks.emplace_back(new MpmcQueue<InlineTask>(queue_capacity));
+
+    start(0, num_threads);
+}
+
+inline void ThreadPool::grow(size_t num_threads) {
+    size_t first = workers.size();
+    if (num_threads <= first)
+        return;
+    // select_cpus deals CPUs out in a fixed order, so the existing workers
+    // keep their CPUs and only the new tail is added
+    worker_cpu = select_cpus(topology, affinity, num_threads);
+    for (size_t i = first; i < num_threads; ++i) {
+        const CpuInfo *info = worker_cpu[i] < 0 ? nullptr : topology.find(worker_cpu[i]);
+        int node = info ? info->node : 0;
+        size_t queue = 0;
+        for (size_t q = 0; q < queue_node.size(); ++q)
+            if (queue_node[q] == node)
+                queue = q;
+        worker_queue.push_back(queue);
+    }
+    start(first, num_threads);
+}
+
+inline void ThreadPool::start(size_t first, size_t last) {
+    for (size_t i = first; i < last; ++i) {
+        workers.emplace_back([this, i] {
+            if (this->worker_cpu[i] >= 0 && pin_current_thread(this->worker_cpu[i]))
+                ++this->pinned;
+            size_t home = this->worker_queue[i];
+            current_pool() = this;
+            current_queue() = home;
+            ++this->started;
+
+            InlineTask task;
+            for (;;) {
+                bool found = false;
+                for (int spin = 0; spin < this->spin_count && !found; ++spin) {
+                    found = this->try_pop_task(home, task);
+                    if (!found) {
+                        if (this->stop.load() && this->pending.load() == 0)
+                            return;
+                        std::this_thread::yield();
+                    }
+                }
+
+                if (!found) {
+                    // Announce the sleep before the final check; producers
+                    // bump pending before reading sleepers, so one of the two
+                    // sides always sees the other (both are seq_cst).
+                    std::unique_lock<std::mutex> lock(this->queue_mutex);
+                    ++this->sleepers;
+                    this->condition.wait(lock, [this] { return this->stop.load() || this->pending.load() != 0; });
+                    --this->sleepers;
+                    if (this->stop.load() && this->pending.load() == 0)
+                        return;
+                    continue;
+                }
+
+                task();
+                task = InlineTask();
+            }
+        });
+    }
+
+    num_workers.store(workers.size());
+
+    // Wait for every worker to settle on its CPU, so describe() is accurate
+    while (started.load() < last)
+        std::this_thread::yield();
+}
+
+inline ThreadPool::~ThreadPool() {
+    {
+        std::unique_lock<std::mutex> lock(queue_mutex);
+        stop = true;
+    }
+    condition.notify_all();
+    for (std::thread &worker : workers)
+        worker.join();
+}
+
+// Own node first, then steal from the other nodes
+inline bool ThreadPool::try_pop_task(size_t home, InlineTask &task) {
+    for (size_t k = 0; k < tasks.size(); ++k) {
+        if (tasks[(home + k) % tasks.size()]->try_pop(task)) {
+            pending.fetch_sub(1);
+            return true;
+        }
+    }
+    return false;
+}
+
+inline size_t ThreadPool::home_queue() {
+    if (current_pool() == this)
+        return current_queue();
+    return next_queue.fetch_add(1, std::memory_order_relaxed) % tasks.size();
+}
+
+template<class F>
+auto ThreadPool::enqueue(F&& f) -> std::future<typename std::result_of<F()>::type> {
+    return submit(home_queue(), std::forward<F>(f));
+}
+
+template<class F>
+auto ThreadPool::enqueue_on_node(int node, F&& f) -> std::future<typename std::result_of<F()>::type> {
+    for (size_t q = 0; q < queue_node.size(); ++q)
+        if (queue_node[q] == node)
+            return submit(q, std::forward<F>(f));
+    return enqueue(std::forward<F>(f));
+}
+
+template<class F>
+void ThreadPool::post(F&& f) {
+    push_task(home_queue(), InlineTask(std::forward<F>(f)));
+}
+
+template<class F>
+auto ThreadPool::submit(size_t queue, F&& f) -> std::future<typename std::result_of<F()>::type> {
+    using return_type = typename std::result_of<F()>::type;
+    // The packaged_task is moved straight into the queue slot; its shared
+    // state is the only allocation left on this path
+    std::packaged_task<return_type()> task(std::forward<F>(f));
+    std::future<return_type> res = task.get_future();
+    push_task(queue, InlineTask(std::move(task)));
+    return res;
+}
+
+inline void ThreadPool::push_task(size_t queue, InlineTask task) {
+    if (stop)
+        throw std::runtime_error("enqueue on stopped ThreadPool");
+    // Count the task before it becomes visible, so pending never underflows
+    pending.fetch_add(1);
+    while (!tasks[queue]->try_push(std::move(task))) {
+        // The ring is full. A worker of this pool drains one task itself,
+        // otherwise all workers could end up waiting on a full queue.
+        InlineTask other;
+        if (current_pool() == this && try_pop_task(queue, other))
+            other();
+        else
+            std::this_thread::yield();
+    }
+    // Spinning workers will see the task on their own; only wake sleepers.
+    // With several nodes, wake everyone so the right node gets a chance.
+    if (sleepers.load() > 0) {
+        // Taking the lock orders this notify after the sleeper's final check
+        { std::lock_guard<std::mutex> lock(queue_mutex); }
+        if (tasks.size() > 1)
+            condition.notify_all();
+        else
+            condition.notify_one();
+    }
+}
+
+inline size_t ThreadPool::get_num_workers() const {
+    return num_workers.load();
+}
+
+inline size_t ThreadPool::get_num_nodes() const {
+    return queue_node.size();
+}
+
+inline std::string ThreadPool::describe() const {
+    std::ostringstream out;
+    out << "pinning: " << affinity.to_string() << ", workers: " << workers.size();
+    if (affinity.policy == PinPolicy::None) {
+        out << ", unpinned";
+        return out.str();
+    }
+    out << ", nodes: " << topology.num_nodes() << ", cores: " << topology.num_cores()
+        << ", cpus: " << topology.cpus.size() << ", pinned: " << pinned.load() << ", map:";
+    for (size_t i = 0; i < worker_cpu.size(); ++i) {
+        const CpuInfo *info = worker_cpu[i] < 0 ? nullptr : topology.find(worker_cpu[i]);
+        out << " w" << i << "->";
+        if (info)
+            out << "cpu" << info->cpu << "(node" << info->node << ",core" << info->core << ")";
+        else
+            out << "any";
+    }
+    return out.str();
+}
+
+// Process-wide pool for the given pinning with at least num_threads
+// workers. There is one pool per pinning, created on first use and grown
+// when a caller asks for more workers, so repeated integrals never pay
+// thread creation and a sweep over thread counts keeps only as many threads
+// as its largest request. The pool may hold more workers than were asked
+// for: callers limit themselves by submitting num_threads tasks, or by
+// passing num_threads to code that would otherwise use get_num_workers().
+inline ThreadPool &persistent_pool(size_t num_threads, const AffinityConfig &affinity = AffinityConfig()) {
+    static std::mutex pools_mutex;
+    static std::map<std::string, std::unique_ptr<ThreadPool>> pools;
+    std::lock_guard<std::mutex> lock(pools_mutex);
+    std::unique_ptr<ThreadPool> &pool = pools[affinity.to_string()];
+    if (!pool)
+        pool.reset(new ThreadPool(num_threads, affinity));
+    else
+        pool->grow(num_threads);
+    return *pool;
+}
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,294 @@
+#ifndef TOPOLOGY_H
+#define TOPOLOGY_H
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// One logical CPU as seen by the OS
+struct CpuInfo {
+    int cpu;      // Logical CPU id
+    int core;     // Physical core id within the package
+    int package;  // Socket id
+    int node;     // NUMA node id
+};
+
+// Largest CPU id a cpulist may name; keeps a typo from expanding to
+// billions of entries
+constexpr int max_cpu_id = 1 << 16;
+
+// Parses a Linux cpulist such as "0-3,8,10-11" into cpus. Returns false,
+// leaving cpus unspecified, unless every item is a number or an ascending
+// range of numbers no larger than max_cpu_id.
+inline bool try_parse_cpu_list(const std::string &list, std::vector<int> &cpus) {
+    auto parse_id = [](const std::string &s, int &id) {
+        if (s.empty() || s.size() > 6)
+            return false;
+        id = 0;
+        for (char ch : s) {
+            if (!std::isdigit(static_cast<unsigned char>(ch)))
+                return false;
+            id = 10 * id + (ch - '0');
+        }
+        return id <= max_cpu_id;
+    };
+
+    cpus.clear();
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (item.empty())
+            continue;
+        size_t dash = item.find('-');
+        int first, last;
+        if (!parse_id(item.substr(0, dash), first))
+            return false;
+        if (dash == std::string::npos)
+            last = first;
+        else if (!parse_id(item.substr(dash + 1), last) || last < first)
+            return false;
+        for (int c = first; c <= last; ++c)
+            cpus.push_back(c);
+    }
+    return true;
+}
+
+// Parses a cpulist read from sysfs; an unreadable list yields no CPUs
+inline std::vector<int> parse_cpu_list(const std::string &list) {
+    std::vector<int> cpus;
+    if (!try_parse_cpu_list(list, cpus))
+        cpus.clear();
+    return cpus;
+}
+
+// CPUs, cores, sockets and NUMA nodes available to this process
+struct Topology {
+    std::vector<CpuInfo> cpus;
+
+    static Topology detect() {
+        namespace fs = std::filesystem;
+        Topology topo;
+
+        std::map<int, int> node_of;
+        std::error_code ec;
+        for (const auto &entry : fs::directory_iterator("/sys/devices/system/node", ec)) {
+            std::string name = entry.path().filename().string();
+            if (name.compare(0, 4, "node") != 0 || name.size() == 4 || !std::isdigit(name[4]))
+                continue;
+            int node = std::stoi(name.substr(4));
+            for (int c : parse_cpu_list(read_line(entry.path() / "cpulist")))
+                node_of[c] = node;
+        }
+
+        for (int c : allowed_cpus()) {
+            std::string base = "/sys/devices/system/cpu/cpu" + std::to_string(c) + "/topology/";
+            std::string core = read_line(base + "core_id");
+            std::string package = read_line(base + "physical_package_id");
+            CpuInfo info;
+            info.cpu = c;
+            info.core = core.empty() ? c : std::stoi(core);
+            info.package = package.empty() ? 0 : std::stoi(package);
+            info.node = node_of.count(c) ? node_of[c] : 0;
+            topo.cpus.push_back(info);
+        }
+        return topo;
+    }
+
+    const CpuInfo *find(int cpu) const {
+        for (const CpuInfo &info : cpus)
+            if (info.cpu == cpu)
+                return &info;
+        return nullptr;
+    }
+
+    int num_nodes() const {
+        std::set<int> nodes;
+        for (const CpuInfo &info : cpus)
+            nodes.insert(info.node);
+        return static_cast<int>(nodes.size());
+    }
+
+    int num_cores() const {
+        std::set<std::pair<int, int>> cores;
+        for (const CpuInfo &info : cpus)
+            cores.insert(std::make_pair(info.package, info.core));
+        return static_cast<int>(cores.size());
+    }
+
+private:
+    static std::string read_line(const std::filesystem::path &path) {
+        std::ifstream in(path);
+        std::string line;
+        std::getline(in, line);
+        return line;
+    }
+
+    // CPUs in the process affinity mask (all hardware threads elsewhere)
+    static std::vector<int> allowed_cpus() {
+        std::vector<int> result;
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+            for (int c = 0; c < CPU_SETSIZE; ++c)
+                if (CPU_ISSET(c, &set))
+                    result.push_back(c);
+        }
+#endif
+        if (result.empty()) {
+            unsigned n = std::max(1u, std::thread::hardware_concurrency());
+            for (unsigned c = 0; c < n; ++c)
+                result.push_back(static_cast<int>(c));
+        }
+        return result;
+    }
+};
+
+// How pool workers are bound to CPUs
+enum class PinPolicy {
+    None,     // Let the OS schedule workers freely
+    Compact,  // Fill one core, socket and node before moving to the next
+    Scatter,  // Round-robin over nodes, then sockets, then cores
+    List      // Use AffinityConfig::cpu_list in order
+};
+
+struct AffinityConfig {
+    PinPolicy policy = PinPolicy::None;
+    bool avoid_smt = false;     // Use at most one hardware thread per core
+    std::vector<int> cpu_list;  // CPUs for PinPolicy::List
+
+    // Stable text form, also used to key persistent pools
+    std::string to_string() const {
+        std::string s;
+        switch (policy) {
+        case PinPolicy::None: s = "none"; break;
+        case PinPolicy::Compact: s = "compact"; break;
+        case PinPolicy::Scatter: s = "scatter"; break;
+        case PinPolicy::List:
+            s = "list:";
+            for (size_t i = 0; i < cpu_list.size(); ++i)
+                s += (i ? "," : "") + std::to_string(cpu_list[i]);
+            break;
+        }
+        return s + (avoid_smt ? ",no-smt" : "");
+    }
+};
+
+// Reads --pin=none|compact|scatter|<cpulist> and --no-smt from the command line.
+// A malformed cpulist is reported on stderr and leaves the workers unpinned.
+inline AffinityConfig parse_affinity_args(int argc, char **argv) {
+    AffinityConfig config;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--no-smt") {
+            config.avoid_smt = true;
+        } else if (arg.compare(0, 6, "--pin=") == 0) {
+            std::string value = arg.substr(6);
+            if (value == "none") {
+                config.policy = PinPolicy::None;
+            } else if (value == "compact") {
+                config.policy = PinPolicy::Compact;
+            } else if (value == "scatter") {
+                config.policy = PinPolicy::Scatter;
+            } else if (try_parse_cpu_list(value, config.cpu_list) && !config.cpu_list.empty()) {
+                config.policy = PinPolicy::List;
+            } else {
+                std::cerr << "Ignoring " << arg << ": expected none, compact, scatter or a cpulist such as 0-3,8;"
+                          << " workers stay unpinned\n";
+                config.policy = PinPolicy::None;
+                config.cpu_list.clear();
+            }
+        }
+    }
+    return config;
+}
+
+// Picks the CPU for each of num_workers workers; -1 means unpinned.
+// When there are more workers than CPUs the assignment wraps around.
+inline std::vector<int> select_cpus(const Topology &topo, const AffinityConfig &config, size_t num_workers) {
+    std::vector<int> assignment(num_workers, -1);
+    if (config.policy == PinPolicy::None || topo.cpus.empty())
+        return assignment;
+
+    std::vector<CpuInfo> candidates;
+    if (config.policy == PinPolicy::List) {
+        for (int c : config.cpu_list)
+            if (const CpuInfo *info = topo.find(c))
+                candidates.push_back(*info);
+    } else {
+        candidates = topo.cpus;
+        auto by_locality = [](const CpuInfo &x, const CpuInfo &y) {
+            return std::make_tuple(x.node, x.package, x.core, x.cpu) < std::make_tuple(y.node, y.package, y.core, y.cpu);
+        };
+        std::sort(candidates.begin(), candidates.end(), by_locality);
+    }
+
+    if (config.avoid_smt) {
+        std::set<std::pair<int, int>> seen;
+        std::vector<CpuInfo> one_per_core;
+        for (const CpuInfo &info : candidates)
+            if (seen.insert(std::make_pair(info.package, info.core)).second)
+                one_per_core.push_back(info);
+        candidates = one_per_core;
+    }
+
+    if (config.policy == PinPolicy::Scatter) {
+        // Deal CPUs out one node at a time; within a node take one hardware
+        // thread per core before coming back for SMT siblings.
+        std::map<int, std::vector<CpuInfo>> per_node;
+        for (const CpuInfo &info : candidates)
+            per_node[info.node].push_back(info);
+        for (auto &entry : per_node) {
+            std::vector<CpuInfo> &cpus = entry.second;
+            std::map<std::pair<int, int>, int> rank;
+            std::vector<std::pair<int, CpuInfo>> ranked;
+            for (const CpuInfo &info : cpus)
+                ranked.push_back(std::make_pair(rank[std::make_pair(info.package, info.core)]++, info));
+            std::stable_sort(ranked.begin(), ranked.end(),
+                             [](const std::pair<int, CpuInfo> &x, const std::pair<int, CpuInfo> &y) { return x.first < y.first; });
+            for (size_t i = 0; i < cpus.size(); ++i)
+                cpus[i] = ranked[i].second;
+        }
+        std::vector<CpuInfo> dealt;
+        for (size_t i = 0; dealt.size() < candidates.size(); ++i)
+            for (auto &entry : per_node)
+                if (i < entry.second.size())
+                    dealt.push_back(entry.second[i]);
+        candidates = dealt;
+    }
+
+    if (candidates.empty())
+        return assignment;
+    for (size_t w = 0; w < num_workers; ++w)
+        assignment[w] = candidates[w % candidates.size()].cpu;
+    return assignment;
+}
+
+// Binds the calling thread to one CPU; returns false if the OS refused
+inline bool pin_current_thread(int cpu) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+#endif // TOPOLOGY_H
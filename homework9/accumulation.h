@@ -0,0 +1,143 @@
+#ifndef ACCUMULATION_H
+#define ACCUMULATION_H
+
+#include <cmath>
+
+// Accumulation policies for long sums. Each policy starts at zero and has
+//   add(v)               add one term
+//   add(values, count)   add a block of terms
+//   value()              the sum rounded to double
+// Integrators take the policy as a template parameter; NaiveSum adds the
+// terms in order exactly like a plain double loop.
+
+// Plain double sum; error grows like n * eps
+struct NaiveSum {
+    double sum = 0.0;
+
+    void add(double v) { sum += v; }
+    void add(const double* values, int count) {
+        for (int i = 0; i < count; ++i)
+            sum += values[i];
+    }
+    double value() const { return sum; }
+};
+
+// Kahan's compensated sum in Neumaier's form, which also covers terms
+// larger than the running sum; error about 2 eps independent of n
+struct NeumaierSum {
+    double sum = 0.0;
+    double correction = 0.0;
+
+    void add(double v) {
+        double t = sum + v;
+        if (std::abs(sum) >= std::abs(v))
+            correction += (sum - t) + v;
+        else
+            correction += (v - t) + sum;
+        sum = t;
+    }
+    void add(const double* values, int count) {
+        for (int i = 0; i < count; ++i)
+            add(values[i]);
+    }
+    void add(const NeumaierSum& other) {
+        add(other.sum);
+        add(other.correction);
+    }
+    double value() const { return sum + correction; }
+};
+
+// Pairwise (cascade) summation for a stream: terms are summed in blocks of
+// 32, and block sums are combined like a binary counter, so partial[k]
+// holds the sum of 2^k blocks. Error grows like log2(n) * eps.
+struct PairwiseSum {
+    enum { blockSize = 32, levels = 64 };
+    double block[blockSize];
+    int filled = 0;
+    double partial[levels];
+    unsigned long long blocks = 0;
+
+    void add(double v) {
+        block[filled++] = v;
+        if (filled == blockSize)
+            flush();
+    }
+    void add(const double* values, int count) {
+        for (int i = 0; i < count; ++i)
+            add(values[i]);
+    }
+    double value() const {
+        double total = 0.0;
+        for (int i = 0; i < filled; ++i)
+            total += block[i];
+        for (int level = 0; level < levels; ++level)
+            if (blocks >> level & 1)
+                total += partial[level];
+        return total;
+    }
+
+private:
+    void flush() {
+        double s = 0.0;
+        for (int i = 0; i < blockSize; ++i)
+            s += block[i];
+        filled = 0;
+        int level = 0;
+        for (unsigned long long carry = blocks; carry & 1; carry >>= 1, ++level)
+            s += partial[level];
+        partial[level] = s;
+        ++blocks;
+    }
+};
+
+// Double-double sum: the running sum is an unevaluated pair hi + lo with
+// about 106 bits of precision, updated with error-free transformations.
+// Blocks go through four independent lanes with no branches, which the
+// compiler turns into SIMD (SLP vectorisation, on at -O2 with gcc 12);
+// lanes are merged only by value(). Do not build with -ffast-math, which
+// removes the error terms.
+struct DoubleDoubleSum {
+    enum { lanes = 4 };
+    double hi[lanes] = {0.0, 0.0, 0.0, 0.0};
+    double lo[lanes] = {0.0, 0.0, 0.0, 0.0};
+
+    void add(double v) { addTo(hi[0], lo[0], v); }
+    void add(const double* values, int count) {
+        // Local copies, so the compiler knows the lanes do not alias values
+        double h[lanes], l[lanes];
+        for (int j = 0; j < lanes; ++j) {
+            h[j] = hi[j];
+            l[j] = lo[j];
+        }
+        int i = 0;
+        for (; i + lanes <= count; i += lanes)
+            for (int j = 0; j < lanes; ++j)
+                addTo(h[j], l[j], values[i + j]);
+        for (int j = 0; i < count; ++i, ++j)
+            addTo(h[j], l[j], values[i]);
+        for (int j = 0; j < lanes; ++j) {
+            hi[j] = h[j];
+            lo[j] = l[j];
+        }
+    }
+    double value() const {
+        double h = hi[0], l = lo[0];
+        for (int j = 1; j < lanes; ++j) {
+            addTo(h, l, hi[j]);
+            addTo(h, l, lo[j]);
+        }
+        return h + l;
+    }
+
+private:
+    // (h, l) += v: TwoSum of h and v, then renormalise with FastTwoSum
+    static void addTo(double& h, double& l, double v) {
+        double s = h + v;
+        double bv = s - h;
+        double e = (h - (s - bv)) + (v - bv) + l;
+        h = s + e;
+        l = e - (h - s);
+    }
+};
+
+#endif // ACCUMULATION_H
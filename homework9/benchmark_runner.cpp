@@ -0,0 +1,309 @@
+// benchmark_runner.cpp
+// Runs the BENCHMARKS.md matrix: all eight trapezoid/Simpson methods on the
+// integrands of complicated_functions.cpp, each with no cache, the slow
+// cache (CachedFunction) and the fast cache (FastCachedFunction).
+//
+// Usage: benchmark_runner [--trials N] [--threads N] [--csv file] [--json file]
+//                         [--persistent-cache file]
+//
+// Every case is run --trials times with a fresh cache and the median time
+// is reported. Cases are independent, so they are spread over --threads
+// worker threads; results are written in matrix order regardless.
+//
+// With --persistent-cache every case is also run through a
+// PersistentCachedFunction on that file. It is shared by all methods, trials
+// and later runs, so a repeated sweep or a restart only evaluates points no
+// earlier run has seen; function_evaluations counts the first trial.
+#include "complicated_functions.h"
+#include "definitions.h"
+#include "integration_methods.h"
+#include "persistent_cache.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Settings from BENCHMARKS.md
+const double tolerance = 1e-8;
+const int maxDepth = 12;
+const int maxIntervals = 2048;
+const int uniformDepth = 11;  // 2^11 = 2048 panels for the non-adaptive recursive rules
+const double lowerBound = 0.0;
+const double upperBound = 1.0;
+
+// Uncached integrand that still counts its evaluations
+class CountingFunction : public Function {
+private:
+    MathFunction func_;
+
+public:
+    explicit CountingFunction(MathFunction func) : func_(func) {}
+
+    double operator()(double x) const override {
+        count++;
+        return func_(x);
+    }
+};
+
+enum class CacheType { None, Slow, Fast, Persistent };
+
+const char* cacheTypeName(CacheType type) {
+    switch (type) {
+    case CacheType::Slow: return "slow";
+    case CacheType::Fast: return "fast";
+    case CacheType::Persistent: return "persistent";
+    default: return "none";
+    }
+}
+
+struct Method {
+    const char* name;
+    double (*integrate)(const MathFunction& f);
+};
+
+const Method methods[] = {
+    {"TrapezoidalNonAdaptiveNonRecursive",
+     [](const MathFunction& f) { return trapezoidalNonRecursive(f, lowerBound, upperBound, maxIntervals); }},
+    {"TrapezoidalNonAdaptiveRecursive",
+     [](const MathFunction& f) { return trapezoidalUniformRecursive(f, lowerBound, upperBound, uniformDepth, 0); }},
+    {"TrapezoidalAdaptiveRecursive",
+     [](const MathFunction& f) {
+         return adaptiveTrapezoidalRecursive(f, lowerBound, upperBound, tolerance, maxDepth, 0);
+     }},
+    {"TrapezoidalAdaptiveNonRecursive",
+     [](const MathFunction& f) {
+         return adaptiveIntegrate(f, lowerBound, upperBound, tolerance, maxDepth, AdaptiveRule::Trapezoid,
+                                  TolerancePolicy::Constant).value;
+     }},
+    {"SimpsonNonAdaptiveNonRecursive",
+     [](const MathFunction& f) { return simpsonNonRecursive(f, lowerBound, upperBound, maxIntervals); }},
+    {"SimpsonNonAdaptiveRecursive",
+     [](const MathFunction& f) { return simpsonUniformRecursive(f, lowerBound, upperBound, uniformDepth, 0); }},
+    {"SimpsonAdaptiveRecursive",
+     [](const MathFunction& f) { return adaptiveSimpsonRecursive(f, lowerBound, upperBound, tolerance, maxDepth, 0); }},
+    {"SimpsonAdaptiveNonRecursive",
+     [](const MathFunction& f) {
+         return adaptiveIntegrate(f, lowerBound, upperBound, tolerance, maxDepth, AdaptiveRule::Simpson,
+                                  TolerancePolicy::Constant).value;
+     }},
+};
+
+struct Integrand {
+    const char* name;
+    double (*f)(double);
+};
+
+const Integrand integrands[] = {
+    {"f1_exp_sin1000x", f1},      {"f2_x^0.75_log1px2", f2}, {"f3_x^10_exp_x3", f3},
+    {"f4_sin_cos_sinh", f4},      {"f5_exp_sin_oscillatory", f5}, {"f6_x^15_sin_sqrt_exp", f6},
+    {"f7_cosh_sin_log", f7},
+};
+
+struct BenchmarkCase {
+    const Method* method;
+    const Integrand* integrand;
+    CacheType cache;
+    double reference;
+};
+
+struct BenchmarkResult {
+    double value;
+    double absoluteError;
+    double relativeError;
+    unsigned int evaluations;  // Cache hits excluded, first trial
+    double medianTime;         // Seconds
+    double minTime;
+};
+
+// Opened by --persistent-cache
+PersistentCache* persistentCache = nullptr;
+
+// Runs one integration with a fresh integrand, returning the value and
+// the number of real evaluations
+double runOnce(const BenchmarkCase& c, unsigned int& evaluations) {
+    switch (c.cache) {
+    case CacheType::Persistent: {
+        PersistentCachedFunction f(c.integrand->f, c.integrand->name, *persistentCache);
+        double value = c.method->integrate(std::cref(f));
+        evaluations = f.getCount();
+        return value;
+    }
+    case CacheType::Slow: {
+        CachedFunction f(c.integrand->f);
+        double value = c.method->integrate(std::cref(f));
+        evaluations = f.getEvaluationCount();
+        return value;
+    }
+    case CacheType::Fast: {
+        FastCachedFunction f(c.integrand->f);
+        double value = c.method->integrate(std::cref(f));
+        evaluations = f.getCount();
+        return value;
+    }
+    default: {
+        CountingFunction f(c.integrand->f);
+        double value = c.method->integrate(std::cref(f));
+        evaluations = f.getCount();
+        return value;
+    }
+    }
+}
+
+BenchmarkResult runCase(const BenchmarkCase& c, int trials) {
+    BenchmarkResult r{};
+    std::vector<double> times;
+    for (int t = 0; t < trials; ++t) {
+        unsigned int evaluations;
+        auto start = std::chrono::high_resolution_clock::now();
+        r.value = runOnce(c, evaluations);
+        auto end = std::chrono::high_resolution_clock::now();
+        times.push_back(std::chrono::duration<double>(end - start).count());
+        if (t == 0)
+            r.evaluations = evaluations;
+    }
+    std::sort(times.begin(), times.end());
+    r.medianTime = times[times.size() / 2];
+    r.minTime = times.front();
+    r.absoluteError = std::abs(r.value - c.reference);
+    r.relativeError = c.reference != 0.0 ? r.absoluteError / std::abs(c.reference) : r.absoluteError;
+    return r;
+}
+
+void saveCSV(const std::vector<BenchmarkCase>& cases, const std::vector<BenchmarkResult>& results, int trials,
+             const std::string& filename) {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Cannot write " << filename << "\n";
+        return;
+    }
+    file << "method_name,function_name,cache_type,numerical_result,reference_result,absolute_error,relative_error,"
+            "function_evaluations,execution_time_sec,min_execution_time_sec,trials,cache_enabled\n";
+    file.precision(17);
+    for (size_t i = 0; i < cases.size(); ++i) {
+        const BenchmarkCase& c = cases[i];
+        const BenchmarkResult& r = results[i];
+        file << c.method->name << "," << c.integrand->name << "," << cacheTypeName(c.cache) << ","
+             << std::defaultfloat << r.value << "," << c.reference << std::scientific << std::setprecision(6) << ","
+             << r.absoluteError << "," << r.relativeError << "," << r.evaluations << "," << r.medianTime << ","
+             << r.minTime << "," << trials << "," << (c.cache != CacheType::None ? "true" : "false") << "\n"
+             << std::setprecision(17);
+    }
+}
+
+void saveJSON(const std::vector<BenchmarkCase>& cases, const std::vector<BenchmarkResult>& results, int trials,
+              const std::string& filename) {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Cannot write " << filename << "\n";
+        return;
+    }
+    file << "{\n  \"tolerance\": " << tolerance << ",\n  \"max_depth\": " << maxDepth
+         << ",\n  \"max_intervals\": " << maxIntervals << ",\n  \"trials\": " << trials << ",\n  \"results\": [\n";
+    for (size_t i = 0; i < cases.size(); ++i) {
+        const BenchmarkCase& c = cases[i];
+        const BenchmarkResult& r = results[i];
+        file << std::defaultfloat << std::setprecision(17) << "    {\"method_name\": \"" << c.method->name
+             << "\", \"function_name\": \"" << c.integrand->name << "\", \"cache_type\": \""
+             << cacheTypeName(c.cache) << "\", \"numerical_result\": " << r.value
+             << ", \"reference_result\": " << c.reference << std::scientific << std::setprecision(6)
+             << ", \"absolute_error\": " << r.absoluteError << ", \"relative_error\": " << r.relativeError
+             << ", \"function_evaluations\": " << r.evaluations << ", \"execution_time_sec\": " << r.medianTime
+             << ", \"min_execution_time_sec\": " << r.minTime << ", \"cache_enabled\": "
+             << (c.cache != CacheType::None ? "true" : "false") << "}" << (i + 1 < cases.size() ? "," : "")
+             << "\n";
+    }
+    file << "  ]\n}\n";
+}
+
+int main(int argc, char** argv) {
+    int trials = 5;
+    int numThreads = std::max(1u, std::thread::hardware_concurrency());
+    std::string csvFile = "benchmark_matrix.csv";
+    std::string jsonFile = "benchmark_matrix.json";
+    std::string persistentFile;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--trials") == 0)
+            trials = std::max(1, std::atoi(argv[i + 1]));
+        else if (std::strcmp(argv[i], "--threads") == 0)
+            numThreads = std::max(1, std::atoi(argv[i + 1]));
+        else if (std::strcmp(argv[i], "--csv") == 0)
+            csvFile = argv[i + 1];
+        else if (std::strcmp(argv[i], "--json") == 0)
+            jsonFile = argv[i + 1];
+        else if (std::strcmp(argv[i], "--persistent-cache") == 0)
+            persistentFile = argv[i + 1];
+        else
+            std::cerr << "Ignoring unknown option " << argv[i] << "\n";
+    }
+
+    // No closed forms are known, so the reference is a tight Gauss-Kronrod
+    // value; roundoff may keep it just above 1e-12, which is still far
+    // below the 1e-8 the methods are asked for
+    std::vector<double> references;
+    for (const Integrand& integrand : integrands) {
+        GaussKronrodResult r =
+            gaussKronrodAdaptive(integrand.f, lowerBound, upperBound, 1e-12, 100000, GaussKronrodRule::G10K21);
+        if (r.error > 1e-10)
+            std::cerr << "Warning: reference for " << integrand.name << " only reached error " << r.error << "\n";
+        references.push_back(r.value);
+    }
+
+    std::unique_ptr<PersistentCache> persistent;
+    if (!persistentFile.empty()) {
+        try {
+            persistent.reset(new PersistentCache(persistentFile));
+        } catch (const std::runtime_error& e) {
+            std::cerr << e.what() << "\n";
+            return 1;
+        }
+        persistentCache = persistent.get();
+    }
+
+    std::vector<BenchmarkCase> cases;
+    for (size_t i = 0; i < sizeof(integrands) / sizeof(integrands[0]); ++i)
+        for (const Method& method : methods)
+            for (CacheType cache : {CacheType::None, CacheType::Slow, CacheType::Fast, CacheType::Persistent})
+                if (cache != CacheType::Persistent || persistent)
+                    cases.push_back(BenchmarkCase{&method, &integrands[i], cache, references[i]});
+
+    // Workers pull case indices; each result lands in its own slot
+    std::vector<BenchmarkResult> results(cases.size());
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+        for (size_t i = next.fetch_add(1); i < cases.size(); i = next.fetch_add(1))
+            results[i] = runCase(cases[i], trials);
+    };
+    auto start = std::chrono::high_resolution_clock::now();
+    std::vector<std::thread> threads;
+    for (int t = 1; t < numThreads; ++t)
+        threads.emplace_back(worker);
+    worker();
+    for (std::thread& t : threads)
+        t.join();
+    auto end = std::chrono::high_resolution_clock::now();
+
+    saveCSV(cases, results, trials, csvFile);
+    saveJSON(cases, results, trials, jsonFile);
+
+    std::cout << cases.size() << " cases x " << trials << " trials on " << numThreads << " threads in "
+              << std::chrono::duration<double>(end - start).count() << " s\n";
+    std::cout << "Results written to " << csvFile << " and " << jsonFile << "\n";
+    if (persistent) {
+        PersistentCache::Stats s = persistent->stats();
+        std::cout << "Persistent cache " << persistentFile << ": " << s.records << " of " << s.capacity
+                  << " records, " << s.hits << " hits, " << s.misses << " misses\n";
+        if (s.records == s.capacity)
+            std::cerr << "Warning: persistent cache is full; new points were not stored\n";
+    }
+    return 0;
+}
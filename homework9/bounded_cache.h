@@ -0,0 +1,197 @@
+#ifndef BOUNDED_CACHE_H
+#define BOUNDED_CACHE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+#include "definitions.h"
+
+// Memory and hit statistics of a BoundedCache
+struct BoundedCacheStats {
+    size_t capacity;        // Maximum number of entries
+    size_t size;            // Entries currently held
+    std::uint64_t hits;
+    std::uint64_t misses;
+    std::uint64_t evictions;
+    size_t bytes;           // Memory held by the table; fixed at construction
+};
+
+// Fixed-capacity cache with CLOCK eviction. Entries live in a preallocated
+// array and are found through an open-addressing index (linear probing,
+// load factor <= 1/2) that is sized once and never rehashes; deletions use
+// backward shifting, so no tombstones accumulate. When full, the clock hand
+// sweeps the entries, giving every recently used one a second chance, and
+// recycles the first unreferenced entry. Not thread-safe on its own.
+class BoundedCache {
+public:
+    explicit BoundedCache(size_t capacity) : entries(capacity), slots(tableSize(capacity), empty) {
+        if (capacity == 0 || capacity >= empty)
+            throw std::invalid_argument("BoundedCache capacity must be in [1, 2^32 - 1)");
+        mask = slots.size() - 1;
+    }
+
+    // Looks key up and marks the entry as recently used
+    bool find(std::uint64_t key, double& value) {
+        size_t slot = findSlot(key);
+        if (slots[slot] == empty) {
+            ++misses;
+            return false;
+        }
+        Entry& e = entries[slots[slot]];
+        e.referenced = true;
+        value = e.value;
+        ++hits;
+        return true;
+    }
+
+    // Inserts or overwrites key, evicting one entry if the cache is full
+    void insert(std::uint64_t key, double value) {
+        size_t slot = findSlot(key);
+        if (slots[slot] != empty) {
+            entries[slots[slot]].value = value;
+            return;
+        }
+        std::uint32_t index;
+        if (used < entries.size()) {
+            index = static_cast<std::uint32_t>(used++);
+        } else {
+            index = evict();
+            slot = findSlot(key);  // Eviction may have shifted the probe sequence
+        }
+        entries[index] = Entry{key, value, false};
+        slots[slot] = index;
+    }
+
+    void clear() {
+        std::fill(slots.begin(), slots.end(), empty);
+        used = 0;
+        hand = 0;
+        hits = misses = evictions = 0;
+    }
+
+    size_t size() const { return used; }
+    size_t capacity() const { return entries.size(); }
+
+    BoundedCacheStats stats() const {
+        return BoundedCacheStats{entries.size(), used, hits, misses, evictions,
+                                 entries.size() * sizeof(Entry) + slots.size() * sizeof(std::uint32_t)};
+    }
+
+private:
+    struct Entry {
+        std::uint64_t key;
+        double value;
+        bool referenced;
+    };
+
+    enum : std::uint32_t { empty = 0xFFFFFFFFu };  // Marks a free slot
+
+    static size_t tableSize(size_t capacity) {
+        size_t n = 2;
+        while (n < 2 * capacity)
+            n <<= 1;
+        return n;
+    }
+
+    static size_t hash(std::uint64_t key) {
+        key ^= key >> 33;
+        key *= 0xff51afd7ed558ccdULL;
+        key ^= key >> 33;
+        return static_cast<size_t>(key);
+    }
+
+    // Slot holding key, or the empty slot where it would go
+    size_t findSlot(std::uint64_t key) const {
+        size_t slot = hash(key) & mask;
+        while (slots[slot] != empty && entries[slots[slot]].key != key)
+            slot = (slot + 1) & mask;
+        return slot;
+    }
+
+    // Advances the clock hand to an unreferenced entry, unlinks it from the
+    // index and returns it for reuse
+    std::uint32_t evict() {
+        for (;;) {
+            Entry& e = entries[hand];
+            if (!e.referenced)
+                break;
+            e.referenced = false;
+            hand = (hand + 1) % entries.size();
+        }
+        std::uint32_t victim = static_cast<std::uint32_t>(hand);
+        hand = (hand + 1) % entries.size();
+        erase(findSlot(entries[victim].key));
+        ++evictions;
+        return victim;
+    }
+
+    // Backward-shift deletion: later entries of the probe run move up into
+    // the hole unless that would put them before their home slot
+    void erase(size_t hole) {
+        size_t next = (hole + 1) & mask;
+        while (slots[next] != empty) {
+            size_t home = hash(entries[slots[next]].key) & mask;
+            if (((next - home) & mask) >= ((next - hole) & mask)) {
+                slots[hole] = slots[next];
+                hole = next;
+            }
+            next = (next + 1) & mask;
+        }
+        slots[hole] = empty;
+    }
+
+    std::vector<Entry> entries;
+    std::vector<std::uint32_t> slots;  // Entry index per slot, or empty
+    size_t mask = 0;
+    size_t used = 0;
+    size_t hand = 0;
+    std::uint64_t hits = 0, misses = 0, evictions = 0;
+};
+
+// Function wrapper whose cache memory stays flat: at most capacity entries
+// are kept, no matter how many distinct x a sweep evaluates
+class BoundedCachedFunction : public Function {
+private:
+    MathFunction func_;
+    mutable BoundedCache cache_;
+    mutable std::mutex mutex_;
+    double tol_;
+    CacheKeyMode mode_;
+
+public:
+    BoundedCachedFunction(MathFunction func, size_t capacity, double tol = 1e-7,
+                          CacheKeyMode mode = CacheKeyMode::Quantized)
+        : func_(func), cache_(capacity), tol_(tol), mode_(mode) {
+        uses_cache = true;
+    }
+
+    double operator()(double x) const override {
+        std::uint64_t key = cacheKey(x, mode_, tol_);
+        double value;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (cache_.find(key, value))
+                return value;
+        }
+        value = func_(x);
+        count++;
+        std::lock_guard<std::mutex> lock(mutex_);
+        cache_.insert(key, value);
+        return value;
+    }
+
+    void clearCache() const override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cache_.clear();
+    }
+
+    BoundedCacheStats getCacheStats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return cache_.stats();
+    }
+};
+
+#endif // BOUNDED_CACHE_H
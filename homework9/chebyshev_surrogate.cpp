@@ -0,0 +1,171 @@
+// chebyshev_surrogate.cpp
+#include "chebyshev_surrogate.h"
+#include "worker_team.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+namespace {
+
+struct Piece {
+    double lo, hi;
+    int depth;
+    std::vector<double> coefficients;
+    bool converged;
+};
+
+// Sum of c[k] T_k(t) by Clenshaw's recurrence
+double clenshaw(const double* c, int n, double t) {
+    double b1 = 0.0, b2 = 0.0;
+    for (int k = n - 1; k >= 1; --k) {
+        double b0 = 2 * t * b1 - b2 + c[k];
+        b2 = b1;
+        b1 = b0;
+    }
+    return t * b1 - b2 + c[0];
+}
+
+// Interpolates f at the degree + 1 Chebyshev extreme points of the piece;
+// cosines[j * (degree + 1) + k] = cos(pi j k / degree)
+void fit(const MathFunction& f, Piece& piece, int degree, const std::vector<double>& cosines, double tolerance) {
+    const int n = degree + 1;
+    double mid = (piece.lo + piece.hi) / 2;
+    double half = (piece.hi - piece.lo) / 2;
+    std::vector<double> samples(n);
+    for (int j = 0; j < n; ++j)
+        samples[j] = f(mid + half * cosines[j * n + 1]);
+
+    piece.coefficients.assign(n, 0.0);
+    double largest = 0.0;
+    for (int k = 0; k < n; ++k) {
+        double sum = 0.5 * (samples[0] + samples[degree] * cosines[degree * n + k]);
+        for (int j = 1; j < degree; ++j)
+            sum += samples[j] * cosines[j * n + k];
+        double c = 2 * sum / degree;
+        if (k == 0 || k == degree)
+            c /= 2;
+        piece.coefficients[k] = c;
+        largest = std::max(largest, std::abs(c));
+    }
+    double tail = std::max(std::abs(piece.coefficients[degree]), std::abs(piece.coefficients[degree - 1]));
+    piece.converged = tail <= tolerance * std::max(1.0, largest);
+}
+
+}  // namespace
+
+ChebyshevSurrogate::ChebyshevSurrogate(const MathFunction& f, double a, double b, const SurrogateOptions& options)
+    : degree(options.degree) {
+    if (!(a < b))
+        throw std::invalid_argument("ChebyshevSurrogate needs a < b");
+    if (degree < 2)
+        throw std::invalid_argument("ChebyshevSurrogate degree must be at least 2");
+
+    const int n = degree + 1;
+    std::vector<double> cosines(n * n);
+    for (int j = 0; j < n; ++j)
+        for (int k = 0; k < n; ++k)
+            cosines[j * n + k] = std::cos(M_PI * ((j * k) % (2 * degree)) / degree);
+
+    // Refinement rounds: fit every open piece, keep the converged ones,
+    // bisect the rest. One team of threads serves all rounds.
+    WorkerTeam team(std::min(options.numThreads, options.maxPieces));
+    std::vector<Piece> open(1, Piece{a, b, 0, {}, false});
+    std::vector<Piece> done;
+    while (!open.empty()) {
+        team.run([&](int t) {
+            for (size_t i = t; i < open.size(); i += team.size())
+                fit(f, open[i], degree, cosines, options.tolerance);
+        });
+        evaluationCount += static_cast<long long>(open.size()) * n;
+
+        std::vector<Piece> next;
+        for (size_t i = 0; i < open.size(); ++i) {
+            Piece& piece = open[i];
+            // Splitting adds one piece to the final count
+            bool full = done.size() + next.size() + (open.size() - i) >= static_cast<size_t>(options.maxPieces);
+            if (piece.converged || piece.depth >= options.maxDepth || full) {
+                allConverged = allConverged && piece.converged;
+                done.push_back(std::move(piece));
+            } else {
+                double mid = (piece.lo + piece.hi) / 2;
+                next.push_back(Piece{piece.lo, mid, piece.depth + 1, {}, false});
+                next.push_back(Piece{mid, piece.hi, piece.depth + 1, {}, false});
+            }
+        }
+        open.swap(next);
+    }
+    std::sort(done.begin(), done.end(), [](const Piece& l, const Piece& r) { return l.lo < r.lo; });
+
+    // Antiderivative and derivative coefficients of every piece, in the
+    // piece's variable t in [-1, 1]
+    const int m = static_cast<int>(done.size());
+    breaks.resize(m + 1);
+    values.resize(m * n);
+    integrals.assign(m * (n + 1), 0.0);
+    derivatives.assign(m * degree, 0.0);
+    cumulative.resize(m + 1);
+    cumulative[0] = 0.0;
+    for (int p = 0; p < m; ++p) {
+        const std::vector<double>& c = done[p].coefficients;
+        breaks[p] = done[p].lo;
+        std::copy(c.begin(), c.end(), values.begin() + p * n);
+
+        // Integral: C_1 = c_0 - c_2 / 2, C_k = (c_{k-1} - c_{k+1}) / 2k,
+        // with C_0 chosen so the antiderivative vanishes at t = -1
+        double* C = &integrals[p * (n + 1)];
+        auto coefficient = [&](int k) { return k < n ? c[k] : 0.0; };
+        C[1] = c[0] - coefficient(2) / 2;
+        for (int k = 2; k <= n; ++k)
+            C[k] = (coefficient(k - 1) - coefficient(k + 1)) / (2 * k);
+        double atMinusOne = 0.0;
+        for (int k = 1; k <= n; ++k)
+            atMinusOne += (k % 2 ? -C[k] : C[k]);
+        C[0] = -atMinusOne;
+
+        // Derivative: d_{k-1} = d_{k+1} + 2k c_k, d_0 halved
+        double* d = &derivatives[p * degree];
+        for (int k = degree; k >= 1; --k)
+            d[k - 1] = (k + 1 < degree ? d[k + 1] : 0.0) + 2 * k * c[k];
+        d[0] /= 2;
+
+        double half = (done[p].hi - done[p].lo) / 2;
+        cumulative[p + 1] = cumulative[p] + half * clenshaw(C, n + 1, 1.0);
+    }
+    breaks[m] = b;
+}
+
+int ChebyshevSurrogate::locate(double x) const {
+    if (x < breaks.front() || x > breaks.back())
+        throw std::out_of_range("Surrogate queried outside its interval");
+    int p = static_cast<int>(std::upper_bound(breaks.begin(), breaks.end(), x) - breaks.begin()) - 1;
+    return std::min(p, pieces() - 1);
+}
+
+double ChebyshevSurrogate::value(double x) const {
+    int p = locate(x);
+    double half = (breaks[p + 1] - breaks[p]) / 2;
+    double t = (x - breaks[p]) / half - 1;
+    return clenshaw(&values[p * (degree + 1)], degree + 1, t);
+}
+
+double ChebyshevSurrogate::derivative(double x) const {
+    int p = locate(x);
+    double half = (breaks[p + 1] - breaks[p]) / 2;
+    double t = (x - breaks[p]) / half - 1;
+    return clenshaw(&derivatives[p * degree], degree, t) / half;
+}
+
+double ChebyshevSurrogate::antiderivative(double x) const {
+    int p = locate(x);
+    double half = (breaks[p + 1] - breaks[p]) / 2;
+    double t = (x - breaks[p]) / half - 1;
+    return cumulative[p] + half * clenshaw(&integrals[p * (degree + 2)], degree + 2, t);
+}
+
+double ChebyshevSurrogate::integral(double x0, double x1) const {
+    return antiderivative(x1) - antiderivative(x0);
+}
@@ -0,0 +1,102 @@
+#ifndef CHEBYSHEV_SURROGATE_H
+#define CHEBYSHEV_SURROGATE_H
+
+#include <memory>
+#include <vector>
+#include "definitions.h"
+
+// Settings of a surrogate fit
+struct SurrogateOptions {
+    int degree = 16;            // Chebyshev degree per piece (degree + 1 samples)
+    double tolerance = 1e-12;   // A piece is accepted once its two highest coefficients
+                                // are below tolerance * max(1, largest coefficient)
+    int maxDepth = 30;          // A piece is never split more often than this
+    int maxPieces = 1 << 16;
+    int numThreads = 1;         // Threads fitting the pieces of one refinement round; f must
+                                // then be safe to call concurrently
+};
+
+// Piecewise Chebyshev approximation of f on [a, b], fitted once and then
+// queried instead of f. Pieces are bisected until their coefficients decay
+// below the tolerance; each round fits all open pieces in parallel. Every
+// query finds its piece by binary search and runs one Clenshaw recurrence,
+// so values, derivatives and integrals over any [x0, x1] cost O(log n +
+// degree) without touching f again. The fit is the same for every thread
+// count.
+class ChebyshevSurrogate {
+public:
+    ChebyshevSurrogate(const MathFunction& f, double a, double b, const SurrogateOptions& options = SurrogateOptions());
+
+    double value(double x) const;
+    double derivative(double x) const;
+    double integral(double x0, double x1) const;  // Throws std::out_of_range outside [a, b]
+
+    double lower() const { return breaks.front(); }
+    double upper() const { return breaks.back(); }
+    int pieces() const { return static_cast<int>(breaks.size()) - 1; }
+    long long evaluations() const { return evaluationCount; }  // Calls to f made by the fit
+    bool converged() const { return allConverged; }            // False if a piece hit maxDepth or maxPieces
+
+private:
+    int locate(double x) const;
+    double antiderivative(double x) const;  // Integral from a to x
+
+    int degree;
+    std::vector<double> breaks;       // pieces() + 1 sorted breakpoints
+    std::vector<double> values;       // Coefficients, degree + 1 per piece
+    std::vector<double> integrals;    // Antiderivative coefficients, degree + 2 per piece
+    std::vector<double> derivatives;  // Derivative coefficients, degree per piece
+    std::vector<double> cumulative;   // Integral from a to each breakpoint
+    long long evaluationCount = 0;
+    bool allConverged = true;
+};
+
+// Cache type that answers from a surrogate of f on [a, b], so it can be
+// passed to any Integration. The surrogate is fitted on the first call (and
+// again after clearCache()). The fit's calls to f count as evaluations and
+// its wall time as evaluation time; calls answered by the surrogate count as
+// cache hits. Points outside [a, b] fall through to f.
+class SurrogateFunction : public CachedFunction {
+private:
+    double lower_, upper_;
+    SurrogateOptions options_;
+    mutable std::unique_ptr<ChebyshevSurrogate> surrogate_;
+
+    void fit() const {
+        auto start = std::chrono::steady_clock::now();
+        surrogate_.reset(new ChebyshevSurrogate(func_, lower_, upper_, options_));
+        if (timing)
+            evaluationTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        evaluationCount += static_cast<int>(surrogate_->evaluations());
+        count += static_cast<unsigned int>(surrogate_->evaluations());
+    }
+
+public:
+    SurrogateFunction(MathFunction func, double a, double b, const SurrogateOptions& options = SurrogateOptions())
+        : CachedFunction(func), lower_(a), upper_(b), options_(options) {
+        uses_cache = true;
+    }
+
+    double operator()(double x) const override {
+        if (x < lower_ || x > upper_) {
+            evaluationCount++;
+            count++;
+            return func_(x);
+        }
+        if (!surrogate_)
+            fit();
+        hitCount++;
+        return surrogate_->value(x);
+    }
+
+    // Drops the fit; the next call fits again
+    void clearCache() const override { surrogate_.reset(); }
+
+    const ChebyshevSurrogate& surrogate() const {
+        if (!surrogate_)
+            fit();
+        return *surrogate_;
+    }
+};
+
+#endif // CHEBYSHEV_SURROGATE_H
@@ -0,0 +1,13 @@
+#ifndef COMPLICATED_FUNCTIONS_H
+#define COMPLICATED_FUNCTIONS_H
+
+// Benchmark integrands from complicated_functions.cpp
+double f1(double x);
+double f2(double x);
+double f3(double x);
+double f4(double x);
+double f5(double x);
+double f6(double x);
+double f7(double x);
+
+#endif // COMPLICATED_FUNCTIONS_H
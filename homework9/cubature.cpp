@@ -0,0 +1,322 @@
+// cubature.cpp
+// Multidimensional cubature: tensor-product Gauss, Smolyak sparse grids,
+// grid volumes and Dunavant rules on triangle surfaces.
+#include "cubature.h"
+#include "worker_team.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+namespace {
+
+// Work is cut into blocks of a fixed size and the block sums are added in
+// block order, so the result does not depend on the number of threads
+const long long blockSize = 4096;
+
+template<class BlockSum>
+double orderedBlockSum(long long items, int numThreads, BlockSum blockSum) {
+    long long blocks = (items + blockSize - 1) / blockSize;
+    std::vector<double> partial(static_cast<size_t>(blocks), 0.0);
+    int threads = static_cast<int>(std::max(1LL, std::min<long long>(numThreads, blocks)));
+
+    WorkerTeam team(threads);
+    team.run([&](int t) {
+        for (long long block = t; block < blocks; block += threads)
+            partial[block] = blockSum(block * blockSize, std::min(items, (block + 1) * blockSize));
+    });
+
+    double sum = 0.0;
+    for (double p : partial)
+        sum += p;
+    return sum;
+}
+
+// Appends the tensor product of 1D rules (one per axis) to rule, with every
+// weight scaled by coefficient
+void appendTensorProduct(CubatureRule& rule, const std::vector<std::vector<double>>& nodes,
+                         const std::vector<std::vector<double>>& weights, double coefficient) {
+    const int dim = rule.dim;
+    std::vector<int> index(dim, 0);
+    for (;;) {
+        double w = coefficient;
+        for (int d = 0; d < dim; ++d) {
+            rule.points.push_back(nodes[d][index[d]]);
+            w *= weights[d][index[d]];
+        }
+        rule.weights.push_back(w);
+
+        int d = dim - 1;
+        while (d >= 0 && ++index[d] == static_cast<int>(nodes[d].size())) {
+            index[d] = 0;
+            --d;
+        }
+        if (d < 0)
+            break;
+    }
+}
+
+// n-point Gauss-Legendre rule mapped onto [lo, hi]
+void mappedGauss(int n, double lo, double hi, std::vector<double>& nodes, std::vector<double>& weights) {
+    gaussLegendre(n, nodes, weights);
+    double c = 0.5 * (lo + hi);
+    double h = 0.5 * (hi - lo);
+    for (int i = 0; i < n; ++i) {
+        nodes[i] = c + h * nodes[i];
+        weights[i] *= h;
+    }
+}
+
+void checkBox(int dim, const std::vector<double>& lower, const std::vector<double>& upper) {
+    if (dim < 1 || static_cast<int>(lower.size()) != dim || static_cast<int>(upper.size()) != dim)
+        throw std::invalid_argument("Box bounds must have one entry per dimension");
+}
+
+// Calls f(first multi-index k, |k|) for every k >= 1 with |k| in [minSum, maxSum]
+void forEachMultiIndex(int dim, int minSum, int maxSum, std::vector<int>& k, int d, int sum,
+                       const std::function<void(const std::vector<int>&, int)>& f) {
+    if (d == dim) {
+        if (sum >= minSum)
+            f(k, sum);
+        return;
+    }
+    int remaining = dim - d - 1;  // Each later axis needs at least 1
+    for (int kd = 1; sum + kd + remaining <= maxSum; ++kd) {
+        k[d] = kd;
+        forEachMultiIndex(dim, minSum, maxSum, k, d + 1, sum + kd, f);
+    }
+}
+
+double binomial(int n, int k) {
+    double r = 1.0;
+    for (int i = 1; i <= k; ++i)
+        r = r * (n - k + i) / i;
+    return r;
+}
+
+// Dunavant rules in barycentric coordinates; weights sum to 1
+struct TrianglePoint {
+    double l1, l2, l3;
+    double weight;
+};
+
+std::vector<TrianglePoint> dunavantRule(int degree) {
+    std::vector<TrianglePoint> rule;
+    auto centroid = [&](double w) { rule.push_back({1.0 / 3, 1.0 / 3, 1.0 / 3, w}); };
+    // The three permutations of (a, b, b)
+    auto orbit = [&](double a, double b, double w) {
+        rule.push_back({a, b, b, w});
+        rule.push_back({b, a, b, w});
+        rule.push_back({b, b, a, w});
+    };
+
+    switch (degree) {
+    case 1:
+        centroid(1.0);
+        break;
+    case 2:
+        orbit(2.0 / 3, 1.0 / 6, 1.0 / 3);
+        break;
+    case 3:
+        centroid(-27.0 / 48);
+        orbit(0.6, 0.2, 25.0 / 48);
+        break;
+    case 4:
+        orbit(0.108103018168070, 0.445948490915965, 0.223381589678011);
+        orbit(0.816847572980459, 0.091576213509771, 0.109951743655322);
+        break;
+    case 5:
+        centroid(0.225);
+        orbit(0.059715871789770, 0.470142064105115, 0.132394152788506);
+        orbit(0.797426985353087, 0.101286507323456, 0.125939180544827);
+        break;
+    default:
+        throw std::invalid_argument("Dunavant rules are available for degree 1 to 5");
+    }
+    return rule;
+}
+
+double triangleArea(const std::array<double, 3>& v1, const std::array<double, 3>& v2,
+                    const std::array<double, 3>& v3) {
+    double r12[3] = {v2[0] - v1[0], v2[1] - v1[1], v2[2] - v1[2]};
+    double r13[3] = {v3[0] - v1[0], v3[1] - v1[1], v3[2] - v1[2]};
+    double cx = r12[1] * r13[2] - r12[2] * r13[1];
+    double cy = r12[2] * r13[0] - r12[0] * r13[2];
+    double cz = r12[0] * r13[1] - r12[1] * r13[0];
+    return 0.5 * std::sqrt(cx * cx + cy * cy + cz * cz);
+}
+
+} // namespace
+
+// Newton iteration on the three-term recurrence for P_n
+void gaussLegendre(int n, std::vector<double>& nodes, std::vector<double>& weights) {
+    if (n < 1)
+        throw std::invalid_argument("Gauss-Legendre needs at least one node");
+    nodes.assign(n, 0.0);
+    weights.assign(n, 0.0);
+    for (int i = 0; i < (n + 1) / 2; ++i) {
+        double x = std::cos(M_PI * (i + 0.75) / (n + 0.5));
+        double dp = 1.0;
+        for (int iter = 0; iter < 100; ++iter) {
+            double p = 1.0, pPrev = 0.0;
+            for (int k = 1; k <= n; ++k) {
+                double pPrev2 = pPrev;
+                pPrev = p;
+                p = ((2 * k - 1) * x * pPrev - (k - 1) * pPrev2) / k;
+            }
+            dp = n * (x * p - pPrev) / (x * x - 1);
+            double dx = p / dp;
+            x -= dx;
+            if (std::abs(dx) < 1e-15)
+                break;
+        }
+        nodes[i] = -x;
+        nodes[n - 1 - i] = x;
+        weights[i] = weights[n - 1 - i] = 2.0 / ((1 - x * x) * dp * dp);
+    }
+}
+
+CubatureRule tensorGaussRule(int dim, int n, const std::vector<double>& lower, const std::vector<double>& upper) {
+    checkBox(dim, lower, upper);
+    std::vector<std::vector<double>> nodes(dim), weights(dim);
+    for (int d = 0; d < dim; ++d)
+        mappedGauss(n, lower[d], upper[d], nodes[d], weights[d]);
+
+    CubatureRule rule{dim, {}, {}};
+    appendTensorProduct(rule, nodes, weights, 1.0);
+    return rule;
+}
+
+// Combination technique: sum over level - dim + 1 <= |k| <= level of
+// (-1)^(level - |k|) * C(dim - 1, level - |k|) * (Q_k1 x ... x Q_kdim),
+// where Q_k is the k-point Gauss rule
+CubatureRule smolyakRule(int dim, int level, const std::vector<double>& lower, const std::vector<double>& upper) {
+    checkBox(dim, lower, upper);
+    if (level < dim)
+        throw std::invalid_argument("Smolyak level must be at least the dimension");
+
+    // 1D rules for every k that can occur, per axis
+    int maxK = level - dim + 1;
+    std::vector<std::vector<std::vector<double>>> nodes1d(dim), weights1d(dim);
+    for (int d = 0; d < dim; ++d) {
+        nodes1d[d].resize(maxK + 1);
+        weights1d[d].resize(maxK + 1);
+        for (int k = 1; k <= maxK; ++k)
+            mappedGauss(k, lower[d], upper[d], nodes1d[d][k], weights1d[d][k]);
+    }
+
+    CubatureRule rule{dim, {}, {}};
+    std::vector<int> k(dim);
+    std::vector<std::vector<double>> nodes(dim), weights(dim);
+    forEachMultiIndex(dim, std::max(dim, level - dim + 1), level, k, 0, 0,
+                      [&](const std::vector<int>& index, int sum) {
+                          int j = level - sum;
+                          double coefficient = (j % 2 == 0 ? 1.0 : -1.0) * binomial(dim - 1, j);
+                          for (int d = 0; d < dim; ++d) {
+                              nodes[d] = nodes1d[d][index[d]];
+                              weights[d] = weights1d[d][index[d]];
+                          }
+                          appendTensorProduct(rule, nodes, weights, coefficient);
+                      });
+    return rule;
+}
+
+double integrateRule(const CubatureRule& rule, const PointBatchFunction& f, int numThreads) {
+    return orderedBlockSum(rule.size(), numThreads, [&](long long begin, long long end) {
+        int n = static_cast<int>(end - begin);
+        std::vector<double> values(n);
+        f(rule.points.data() + begin * rule.dim, values.data(), n);
+        double sum = 0.0;
+        for (int i = 0; i < n; ++i)
+            sum += rule.weights[begin + i] * values[i];
+        return sum;
+    });
+}
+
+double gridVolumeIntegral(const double* values, int nx, int ny, int nz, double hx, double hy, double hz,
+                          int numThreads) {
+    // Composite weights along one axis, spacing included
+    auto axisWeights = [](int n, double h) {
+        std::vector<double> w(n, h);
+        if (n == 1) {
+            w[0] = 0.0;
+        } else if (n % 2 == 1) {
+            for (int i = 0; i < n; ++i)
+                w[i] = h / 3 * (i == 0 || i == n - 1 ? 1 : (i % 2 == 1 ? 4 : 2));
+        } else {
+            w[0] = w[n - 1] = 0.5 * h;
+        }
+        return w;
+    };
+    std::vector<double> wx = axisWeights(nx, hx), wy = axisWeights(ny, hy), wz = axisWeights(nz, hz);
+
+    long long slab = static_cast<long long>(ny) * nz;
+    return orderedBlockSum(nx * slab, numThreads, [&](long long begin, long long end) {
+        double sum = 0.0;
+        for (long long idx = begin; idx < end; ++idx) {
+            long long i = idx / slab;
+            long long j = (idx / nz) % ny;
+            long long k = idx % nz;
+            sum += wx[i] * wy[j] * wz[k] * values[idx];
+        }
+        return sum;
+    });
+}
+
+int dunavantPoints(int degree) {
+    return static_cast<int>(dunavantRule(degree).size());
+}
+
+// Each block gathers the physical quadrature points of its triangles into
+// one contiguous batch, evaluates them with a single call and sums
+// area * weight * value in triangle order
+double surfaceIntegral(const MeshVertices& vertices, const MeshTriangles& triangles, const PointBatchFunction& f,
+                       int degree, int numThreads) {
+    const std::vector<TrianglePoint> rule = dunavantRule(degree);
+    const int p = static_cast<int>(rule.size());
+
+    return orderedBlockSum(static_cast<long long>(triangles.size()), numThreads,
+                           [&](long long begin, long long end) {
+        int n = static_cast<int>(end - begin) * p;
+        std::vector<double> points(3 * n), values(n), areas(end - begin);
+        double* out = points.data();
+        for (long long t = begin; t < end; ++t) {
+            const auto& v1 = vertices[triangles[t][0]];
+            const auto& v2 = vertices[triangles[t][1]];
+            const auto& v3 = vertices[triangles[t][2]];
+            areas[t - begin] = triangleArea(v1, v2, v3);
+            for (const TrianglePoint& q : rule)
+                for (int c = 0; c < 3; ++c)
+                    *out++ = q.l1 * v1[c] + q.l2 * v2[c] + q.l3 * v3[c];
+        }
+        f(points.data(), values.data(), n);
+
+        double sum = 0.0;
+        for (long long t = 0; t < end - begin; ++t) {
+            double s = 0.0;
+            for (int q = 0; q < p; ++q)
+                s += rule[q].weight * values[t * p + q];
+            sum += areas[t] * s;
+        }
+        return sum;
+    });
+}
+
+double vertexFieldIntegral(const MeshVertices& vertices, const MeshTriangles& triangles,
+                           const std::vector<double>& values, int numThreads) {
+    if (values.size() != vertices.size())
+        throw std::invalid_argument("Vertex field needs one value per vertex");
+    return orderedBlockSum(static_cast<long long>(triangles.size()), numThreads,
+                           [&](long long begin, long long end) {
+        double sum = 0.0;
+        for (long long t = begin; t < end; ++t) {
+            const auto& tri = triangles[t];
+            double area = triangleArea(vertices[tri[0]], vertices[tri[1]], vertices[tri[2]]);
+            sum += area * (values[tri[0]] + values[tri[1]] + values[tri[2]]) / 3.0;
+        }
+        return sum;
+    });
+}
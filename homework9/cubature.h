@@ -0,0 +1,58 @@
+#ifndef CUBATURE_H
+#define CUBATURE_H
+
+#include <array>
+#include <functional>
+#include <vector>
+
+// Evaluates a field at n points stored interleaved (x0 y0 [z0] x1 y1 ...)
+// into values[0..n). Points are always handed over in contiguous batches.
+using PointBatchFunction = std::function<void(const double* points, double* values, int n)>;
+
+// A cubature rule on a box: nodes (dim coordinates each) and weights
+struct CubatureRule {
+    int dim;
+    std::vector<double> points;   // size() == dim * weights.size()
+    std::vector<double> weights;
+
+    int size() const { return static_cast<int>(weights.size()); }
+};
+
+// Gauss-Legendre nodes and weights on [-1, 1]
+void gaussLegendre(int n, std::vector<double>& nodes, std::vector<double>& weights);
+
+// n^dim-point tensor-product Gauss-Legendre rule on the box [lower, upper]
+CubatureRule tensorGaussRule(int dim, int n, const std::vector<double>& lower, const std::vector<double>& upper);
+
+// Smolyak sparse grid built from Gauss-Legendre rules with the combination
+// technique; level is the total level (level >= dim), exact for total degree
+// 2 * (level - dim) + 1
+CubatureRule smolyakRule(int dim, int level, const std::vector<double>& lower, const std::vector<double>& upper);
+
+// Applies a rule in fixed-size batches on numThreads threads. The result is
+// bitwise identical for every thread count.
+double integrateRule(const CubatureRule& rule, const PointBatchFunction& f, int numThreads = 1);
+
+// Integral of samples on an nx*ny*nz grid with spacings hx, hy, hz, stored in
+// the Grid1 layout (index i*ny*nz + j*nz + k). Uses composite Simpson along
+// each axis with an odd point count, composite trapezoid otherwise.
+double gridVolumeIntegral(const double* values, int nx, int ny, int nz, double hx, double hy, double hz,
+                          int numThreads = 1);
+
+// Triangle surfaces in the BrainMesh layout
+using MeshVertices = std::vector<std::array<double, 3>>;
+using MeshTriangles = std::vector<std::array<long, 3>>;
+
+// Number of points in the Dunavant rule of the given degree (1 to 5)
+int dunavantPoints(int degree);
+
+// Surface integral of a field over all triangles with a Dunavant rule
+double surfaceIntegral(const MeshVertices& vertices, const MeshTriangles& triangles, const PointBatchFunction& f,
+                       int degree = 2, int numThreads = 1);
+
+// Surface integral of a field given at the vertices and interpolated
+// linearly over each triangle (exact for that interpolant)
+double vertexFieldIntegral(const MeshVertices& vertices, const MeshTriangles& triangles,
+                           const std::vector<double>& values, int numThreads = 1);
+
+#endif // CUBATURE_H
@@ -0,0 +1,146 @@
+// cubature_demo.cpp
+// Accuracy and timing of the cubature engine on boxes, grid volumes and a
+// cortex-sized triangle surface.
+#include "cubature.h"
+#include "../homework5/brain_mesh.h"
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// Unit sphere with nLat rings of nLon vertices plus the two poles
+void makeSphere(int nLat, int nLon, MeshVertices& vertices, MeshTriangles& triangles) {
+    vertices.clear();
+    triangles.clear();
+    vertices.push_back({0.0, 0.0, 1.0});
+    for (int i = 1; i <= nLat; ++i) {
+        double theta = M_PI * i / (nLat + 1);
+        for (int j = 0; j < nLon; ++j) {
+            double phi = 2 * M_PI * j / nLon;
+            vertices.push_back({std::sin(theta) * std::cos(phi), std::sin(theta) * std::sin(phi), std::cos(theta)});
+        }
+    }
+    vertices.push_back({0.0, 0.0, -1.0});
+    long south = static_cast<long>(vertices.size()) - 1;
+
+    auto ring = [nLon](int i, int j) { return 1L + static_cast<long>(i) * nLon + (j % nLon); };
+    for (int j = 0; j < nLon; ++j) {
+        triangles.push_back({0L, ring(0, j), ring(0, j + 1)});
+        triangles.push_back({south, ring(nLat - 1, j + 1), ring(nLat - 1, j)});
+    }
+    for (int i = 0; i + 1 < nLat; ++i) {
+        for (int j = 0; j < nLon; ++j) {
+            triangles.push_back({ring(i, j), ring(i + 1, j), ring(i + 1, j + 1)});
+            triangles.push_back({ring(i, j), ring(i + 1, j + 1), ring(i, j + 1)});
+        }
+    }
+}
+
+template<class F>
+double timeIt(F f, double& result) {
+    auto start = std::chrono::high_resolution_clock::now();
+    result = f();
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+bool sameBits(double x, double y) {
+    return std::memcmp(&x, &y, sizeof(double)) == 0;
+}
+
+int main() {
+    std::cout.precision(15);
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+
+    // exp(x1 + ... + xd) on the unit cube integrates to (e - 1)^d
+    auto expSum = [](int dim) {
+        return PointBatchFunction([dim](const double* p, double* v, int n) {
+            for (int i = 0; i < n; ++i) {
+                double s = 0.0;
+                for (int d = 0; d < dim; ++d)
+                    s += p[i * dim + d];
+                v[i] = std::exp(s);
+            }
+        });
+    };
+
+    std::cout << "Box [0, 1]^d, f = exp(sum x):\n";
+    for (int dim : {2, 3, 6}) {
+        std::vector<double> lower(dim, 0.0), upper(dim, 1.0);
+        double exact = std::pow(std::exp(1.0) - 1.0, dim);
+        for (int n : {3, 5}) {
+            CubatureRule rule = tensorGaussRule(dim, n, lower, upper);
+            double r = integrateRule(rule, expSum(dim), threads);
+            std::cout << "  d=" << dim << " tensor Gauss n=" << n << ": " << rule.size()
+                      << " points, error " << std::abs(r - exact) << "\n";
+        }
+        for (int extra : {3, 5}) {
+            CubatureRule rule = smolyakRule(dim, dim + extra, lower, upper);
+            double r = integrateRule(rule, expSum(dim), threads);
+            std::cout << "  d=" << dim << " Smolyak level d+" << extra << ": " << rule.size()
+                      << " points, error " << std::abs(r - exact) << "\n";
+        }
+    }
+
+    // Grid volume in the Grid1 layout
+    const int ng = 129;
+    const double h = 1.0 / (ng - 1);
+    std::vector<double> samples(static_cast<size_t>(ng) * ng * ng);
+    for (int i = 0; i < ng; ++i)
+        for (int j = 0; j < ng; ++j)
+            for (int k = 0; k < ng; ++k)
+                samples[(static_cast<size_t>(i) * ng + j) * ng + k] = std::exp(i * h + j * h + k * h);
+    double volume = 0.0;
+    double ms = timeIt([&]() { return gridVolumeIntegral(samples.data(), ng, ng, ng, h, h, h, threads); }, volume);
+    std::cout << "\nGrid " << ng << "^3 Simpson: error " << std::abs(volume - std::pow(std::exp(1.0) - 1.0, 3))
+              << " in " << ms << " ms\n";
+
+    // Cortex surface if the homework5 data is present, otherwise a sphere of similar size
+    MeshVertices vertices;
+    MeshTriangles triangles;
+    const std::string vtk = "../homework5/Cort_lobe_poly.vtk";
+    bool sphere = !std::ifstream(vtk).good();
+    if (sphere) {
+        makeSphere(300, 640, vertices, triangles);
+        std::cout << "\n" << vtk << " not found, using a unit sphere with " << vertices.size() << " vertices and "
+                  << triangles.size() << " triangles\n";
+    } else {
+        BrainMesh<double, long> brain("cortex");
+        brain.readData(vtk);
+        vertices = brain.getVertices();
+        triangles = brain.getTriangles();
+    }
+
+    std::vector<double> z2(vertices.size());
+    for (size_t i = 0; i < vertices.size(); ++i)
+        z2[i] = vertices[i][2] * vertices[i][2];
+    PointBatchFunction z2Field = [](const double* p, double* v, int n) {
+        for (int i = 0; i < n; ++i)
+            v[i] = p[3 * i + 2] * p[3 * i + 2];
+    };
+
+    double serial = 0.0, parallel = 0.0;
+    double serialMs = timeIt([&]() { return vertexFieldIntegral(vertices, triangles, z2, 1); }, serial);
+    // Deterministic reduction: any thread count gives the same bits
+    int many = std::max(4, threads);
+    double parallelMs = timeIt([&]() { return vertexFieldIntegral(vertices, triangles, z2, many); }, parallel);
+    std::cout << "Vertex field z^2: " << parallel << " (1 thread " << serialMs << " ms, " << many << " threads "
+              << parallelMs << " ms, identical: " << (sameBits(serial, parallel) ? "yes" : "no") << ")\n";
+
+    for (int degree = 1; degree <= 5; ++degree) {
+        double r = 0.0;
+        double t = timeIt([&]() { return surfaceIntegral(vertices, triangles, z2Field, degree, threads); }, r);
+        std::cout << "Dunavant degree " << degree << " (" << dunavantPoints(degree) << " points): " << r << " in "
+                  << t << " ms\n";
+    }
+    if (sphere)
+        std::cout << "Exact on the smooth sphere: " << 4 * M_PI / 3 << "\n";
+
+    return 0;
+}
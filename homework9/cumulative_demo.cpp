@@ -0,0 +1,65 @@
+// cumulative_demo.cpp
+// Antiderivative table of exp(-x^2) at 10^6 + 1 points of [0, 4], against
+// sqrt(pi)/2 erf(x): built on one thread and on all of them, compared with
+// a plain running sum of the same increments, and written to CSV and binary.
+#include "cumulative_integration.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+int main() {
+    const double a = 0.0, b = 4.0;
+    const int intervals = 1000000;
+    auto f = [](double x) { return std::exp(-x * x); };
+    auto exact = [](double x) { return 0.5 * std::sqrt(M_PI) * std::erf(x); };
+
+    CumulativeOptions options;
+    std::cout.precision(6);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    AntiderivativeTable serial(f, a, b, intervals, options);
+    auto middle = std::chrono::high_resolution_clock::now();
+    options.numThreads = std::max(1u, std::thread::hardware_concurrency());
+    AntiderivativeTable parallel(f, a, b, intervals, options);
+    auto end = std::chrono::high_resolution_clock::now();
+
+    // Plain running sum of the same increments
+    const std::vector<double>& x = serial.points();
+    const std::vector<double>& F = serial.values();
+    double naive = 0.0, naiveError = 0.0, tableError = 0.0, threadDifference = 0.0;
+    int differing = 0;
+    for (size_t i = 1; i < x.size(); ++i) {
+        naive += serial.increments()[i - 1];
+        double reference = exact(x[i]);
+        naiveError = std::max(naiveError, std::abs(naive - reference));
+        tableError = std::max(tableError, std::abs(F[i] - reference));
+        double difference = std::abs(F[i] - parallel.values()[i]);
+        threadDifference = std::max(threadDifference, difference);
+        differing += difference != 0.0;
+    }
+
+    std::cout << "F(x) = integral of exp(-x^2) from " << a << " at " << serial.size() << " points of [" << a << ", " << b
+              << "]:\n"
+              << "  1 thread: " << std::chrono::duration<double>(middle - start).count() << " s, "
+              << serial.evaluations() << " evaluations" << (serial.converged() ? "" : " (not converged)") << "\n"
+              << "  " << options.numThreads << " thread(s): " << std::chrono::duration<double>(end - middle).count()
+              << " s, max difference to 1 thread " << threadDifference << " (" << differing << " points)\n"
+              << "  max error: compensated " << tableError << ", plain running sum " << naiveError
+              << ", estimate " << serial.errorEstimate() << "\n";
+
+    start = std::chrono::high_resolution_clock::now();
+    serial.writeCsv("cumulative_table.csv");
+    middle = std::chrono::high_resolution_clock::now();
+    serial.writeBinary("cumulative_table.bin");
+    end = std::chrono::high_resolution_clock::now();
+    std::cout << "  wrote cumulative_table.csv in " << std::chrono::duration<double>(middle - start).count()
+              << " s and cumulative_table.bin in " << std::chrono::duration<double>(end - middle).count() << " s\n";
+    return 0;
+}
@@ -0,0 +1,119 @@
+// cumulative_integration.cpp
+#include "cumulative_integration.h"
+#include "accumulation.h"
+#include "worker_team.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+
+// Runs body(t, begin, end) on every worker of team over contiguous blocks of [0, n)
+template<class Body>
+void forEachBlock(WorkerTeam& team, size_t n, Body body) {
+    const size_t workers = team.size();
+    team.run([&](int t) { body(t, n * t / workers, n * (t + 1) / workers); });
+}
+
+}  // namespace
+
+AntiderivativeTable::AntiderivativeTable(const MathFunction& f, const std::vector<double>& points,
+                                         const CumulativeOptions& options)
+    : x(points) {
+    if (x.empty())
+        throw std::invalid_argument("AntiderivativeTable needs at least one point");
+    if (!std::is_sorted(x.begin(), x.end()))
+        throw std::invalid_argument("AntiderivativeTable points must be sorted");
+    build(f, options);
+}
+
+AntiderivativeTable::AntiderivativeTable(const MathFunction& f, double a, double b, int intervals,
+                                         const CumulativeOptions& options) {
+    if (intervals < 1 || !(a < b))
+        throw std::invalid_argument("AntiderivativeTable needs a < b and at least one interval");
+    x.resize(intervals + 1);
+    for (int i = 0; i <= intervals; ++i)
+        x[i] = a + (b - a) * i / intervals;
+    x[intervals] = b;
+    build(f, options);
+}
+
+void AntiderivativeTable::build(const MathFunction& f, const CumulativeOptions& options) {
+    const size_t m = x.size() - 1;  // Subintervals
+    const double width = x.back() - x.front();
+    pieces.assign(m, 0.0);
+    F.assign(m + 1, 0.0);
+    if (m == 0)
+        return;
+
+    const int threads = std::max(1, static_cast<int>(std::min<size_t>(std::max(options.numThreads, 1), m)));
+    std::vector<NeumaierSum> totals(threads);
+    std::vector<double> errors(threads, 0.0);
+    std::vector<long long> evaluations(threads, 0);
+    std::vector<char> converged(threads, 1);
+    WorkerTeam team(threads);  // Shared by both passes
+
+    // Pass 1: integrate every subinterval and sum each block
+    forEachBlock(team, m, [&](int t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            double lo = x[i], hi = x[i + 1];
+            if (hi == lo)
+                continue;
+            double tol = width > 0 ? options.tolerance * (hi - lo) / width : options.tolerance;
+            GaussKronrodResult r = gaussKronrodAdaptive(f, lo, hi, tol, options.maxIntervals, options.rule);
+            pieces[i] = r.value;
+            totals[t].add(r.value);
+            errors[t] += r.error;
+            evaluations[t] += r.evaluations;
+            converged[t] = converged[t] && r.converged;
+        }
+    });
+
+    // Exclusive scan of the block totals, in block order
+    std::vector<NeumaierSum> offsets(threads);
+    for (int t = 1; t < threads; ++t) {
+        offsets[t] = offsets[t - 1];
+        offsets[t].add(totals[t - 1]);
+    }
+
+    // Pass 2: running sums within each block, starting from its offset
+    forEachBlock(team, m, [&](int t, size_t begin, size_t end) {
+        NeumaierSum running = offsets[t];
+        for (size_t i = begin; i < end; ++i) {
+            running.add(pieces[i]);
+            F[i + 1] = running.value();
+        }
+    });
+
+    for (int t = 0; t < threads; ++t) {
+        error += errors[t];
+        evaluationCount += evaluations[t];
+        allConverged = allConverged && converged[t];
+    }
+}
+
+void AntiderivativeTable::writeCsv(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file)
+        throw std::runtime_error("Cannot write " + path);
+    file.precision(17);
+    file << "x,F\n";
+    for (size_t i = 0; i < x.size(); ++i)
+        file << x[i] << ',' << F[i] << '\n';
+    if (!file)
+        throw std::runtime_error("Error while writing " + path);
+}
+
+void AntiderivativeTable::writeBinary(const std::string& path) const {
+    std::ofstream file(path, std::ios::binary);
+    if (!file)
+        throw std::runtime_error("Cannot write " + path);
+    std::uint64_t count = x.size();
+    file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    file.write(reinterpret_cast<const char*>(x.data()), static_cast<std::streamsize>(x.size() * sizeof(double)));
+    file.write(reinterpret_cast<const char*>(F.data()), static_cast<std::streamsize>(F.size() * sizeof(double)));
+    if (!file)
+        throw std::runtime_error("Error while writing " + path);
+}
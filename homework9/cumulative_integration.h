@@ -0,0 +1,55 @@
+#ifndef CUMULATIVE_INTEGRATION_H
+#define CUMULATIVE_INTEGRATION_H
+
+#include <string>
+#include <vector>
+#include "integration_methods.h"
+
+// Settings of an antiderivative table
+struct CumulativeOptions {
+    double tolerance = 1e-12;   // Absolute tolerance for the whole of [a, b]; each subinterval gets
+                                // the share of its width
+    int maxIntervals = 64;      // Gauss-Kronrod subdivisions allowed per subinterval
+    GaussKronrodRule rule = GaussKronrodRule::G7K15;
+    int numThreads = 1;         // f must then be safe to call concurrently
+};
+
+// Dense table of F(x_i) = integral of f from x_0 to x_i at sorted points.
+// Every subinterval [x_{i-1}, x_i] is integrated independently by adaptive
+// Gauss-Kronrod, split into one contiguous block per thread. The running
+// sums are then a parallel prefix scan: each thread sums its block, the
+// block totals are scanned in order, and each thread adds its block's
+// offset back in. All sums carry a Neumaier correction term, so the
+// rounding error of F stays near one ulp instead of growing with the
+// number of points.
+class AntiderivativeTable {
+public:
+    AntiderivativeTable(const MathFunction& f, const std::vector<double>& points,
+                        const CumulativeOptions& options = CumulativeOptions());
+    // intervals + 1 equally spaced points from a to b
+    AntiderivativeTable(const MathFunction& f, double a, double b, int intervals,
+                        const CumulativeOptions& options = CumulativeOptions());
+
+    const std::vector<double>& points() const { return x; }
+    const std::vector<double>& values() const { return F; }              // F[0] = 0
+    const std::vector<double>& increments() const { return pieces; }     // Integral over each subinterval
+    size_t size() const { return x.size(); }
+    double errorEstimate() const { return error; }     // Sum of the subinterval error estimates
+    long long evaluations() const { return evaluationCount; }
+    bool converged() const { return allConverged; }  // False if a subinterval missed its tolerance
+
+    // "x,F" rows at full precision
+    void writeCsv(const std::string& path) const;
+    // Native-endian: uint64 point count, then the points, then F, as doubles
+    void writeBinary(const std::string& path) const;
+
+private:
+    void build(const MathFunction& f, const CumulativeOptions& options);
+
+    std::vector<double> x, F, pieces;
+    double error = 0.0;
+    long long evaluationCount = 0;
+    bool allConverged = true;
+};
+
+#endif // CUMULATIVE_INTEGRATION_H
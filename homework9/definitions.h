@@ -5,17 +5,152 @@
 #include <unordered_map>
 #include <cmath>
 #include <iostream>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include "trace.h"
 
 // Define a type alias for mathematical functions
 using MathFunction = std::function<double(double)>;
 
+// How a cache turns x into a key
+enum class CacheKeyMode {
+    ExactBits,  // Only bitwise-equal x share an entry (-0.0 and 0.0 are merged)
+    Quantized   // x values in the same bin of width tol share an entry
+};
+
+// 64-bit cache key for x. Bins are 64-bit, so round(x / tol) no longer
+// overflows for |x| > ~214 at tol = 1e-7. Quantized keys are split on the
+// top bit: bins with |bin| < 2^62 keep it clear (bits 62 and 63 of such an
+// int64 are equal, so dropping bit 63 loses nothing), while larger, infinite
+// or NaN bins set it and store the double bin itself. Its exponent field is
+// then at least 1085 (2^62), so the sign, exponent - 1085 and mantissa fit in
+// the remaining 63 bits and the two halves never share a key.
+inline std::uint64_t cacheKey(double x, CacheKeyMode mode, double tol) {
+    if (mode == CacheKeyMode::Quantized) {
+        const std::uint64_t largeBin = 1ULL << 63;
+        double bin = std::round(x / tol);
+        if (std::abs(bin) < 4611686018427387904.0)  // 2^62
+            return static_cast<std::uint64_t>(static_cast<std::int64_t>(bin)) & ~largeBin;
+        std::uint64_t bits;
+        std::memcpy(&bits, &bin, sizeof(bits));
+        std::uint64_t sign = bits >> 63;
+        std::uint64_t exponent = ((bits >> 52) & 0x7ff) - 1085;
+        std::uint64_t mantissa = bits & ((1ULL << 52) - 1);
+        return largeBin | sign << 62 | exponent << 52 | mantissa;
+    }
+    if (x == 0.0)
+        x = 0.0;
+    std::uint64_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    return bits;
+}
+
+// Hit/miss counters of a cache
+struct CacheStats {
+    std::uint64_t hits;
+    std::uint64_t misses;
+
+    double hitRate() const { return hits + misses ? static_cast<double>(hits) / (hits + misses) : 0.0; }
+};
+
+// Thread-safe memoization table split into lock-striped shards. The shard is
+// picked from a mixed hash of the key, so threads working on neighbouring
+// subintervals rarely contend for the same lock. The function is evaluated
+// outside the lock; two threads missing on the same key at once may both
+// evaluate it.
+class ShardedCache {
+public:
+    explicit ShardedCache(int numShards = 64) : shardMask(roundUpPow2(numShards) - 1),
+                                                shards(new Shard[shardMask + 1]) {}
+
+    template<class F>
+    double getOrCompute(std::uint64_t key, F compute) {
+        Shard& shard = shards[shardIndex(key)];
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            auto it = shard.map.find(key);
+            if (it != shard.map.end()) {
+                shard.hits.fetch_add(1, std::memory_order_relaxed);
+                return it->second;
+            }
+        }
+        shard.misses.fetch_add(1, std::memory_order_relaxed);
+        double value = compute();
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.map.emplace(key, value);
+        return value;
+    }
+
+    void clear() {
+        for (size_t i = 0; i <= shardMask; ++i) {
+            std::lock_guard<std::mutex> lock(shards[i].mutex);
+            shards[i].map.clear();
+            shards[i].hits.store(0, std::memory_order_relaxed);
+            shards[i].misses.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    CacheStats stats() const {
+        CacheStats s{0, 0};
+        for (size_t i = 0; i <= shardMask; ++i) {
+            s.hits += shards[i].hits.load(std::memory_order_relaxed);
+            s.misses += shards[i].misses.load(std::memory_order_relaxed);
+        }
+        return s;
+    }
+
+    size_t size() const {
+        size_t n = 0;
+        for (size_t i = 0; i <= shardMask; ++i) {
+            std::lock_guard<std::mutex> lock(shards[i].mutex);
+            n += shards[i].map.size();
+        }
+        return n;
+    }
+
+private:
+    struct Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<std::uint64_t, double> map;
+        std::atomic<std::uint64_t> hits{0};
+        std::atomic<std::uint64_t> misses{0};
+        char padding[64];  // Keeps neighbouring shards' locks off one cache line
+    };
+
+    static size_t roundUpPow2(int n) {
+        size_t p = 1;
+        while (p < static_cast<size_t>(n))
+            p <<= 1;
+        return p;
+    }
+
+    // splitmix64 finaliser: bins of neighbouring x differ only in low bits
+    size_t shardIndex(std::uint64_t key) const {
+        key ^= key >> 30;
+        key *= 0xbf58476d1ce4e5b9ULL;
+        key ^= key >> 27;
+        key *= 0x94d049bb133111ebULL;
+        key ^= key >> 31;
+        return static_cast<size_t>(key) & shardMask;
+    }
+
+    size_t shardMask;
+    std::unique_ptr<Shard[]> shards;
+};
+
 // Base Function class
 class Function {
 protected:
-    mutable unsigned int count{0};  // Tracks number of evaluations
-    bool uses_cache{false};         // Indicates if caching is enabled
+    mutable std::atomic<unsigned int> count{0};  // Tracks number of evaluations (safe to share between threads)
+    bool uses_cache{false};                      // Indicates if caching is enabled
 
 public:
+    Function() = default;
+    Function(const Function& other) : count(other.count.load()), uses_cache(other.uses_cache) {}
     virtual double operator()(double x) const = 0;  // Pure virtual function
     virtual ~Function() = default;
 
@@ -38,73 +173,91 @@ public:
     }
 };
 
-// CachedFunction class to cache results of function evaluations
+// CachedFunction class to cache results of function evaluations. Other
+// cache types derive from it and keep its counters, so every Integration
+// can take them.
 class CachedFunction : public Function {
 private:
-    MathFunction func_;
-    mutable std::unordered_map<int, double> cache_; 
-    mutable int evaluationCount;  
+    mutable std::unordered_map<std::uint64_t, double> cache_; 
     double tol;  
 
+protected:
+    MathFunction func_;
+    mutable int evaluationCount;      // Calls to func_
+    mutable int hitCount;             // Lookups answered from the cache
+    mutable double evaluationTime;    // Seconds inside func_, summed while timing is on
+    bool timing;
+
 public:
     explicit CachedFunction(MathFunction func, double tolerance = 1e-7)
-        : func_(func), evaluationCount(0),tol(tolerance){}
+        : tol(tolerance), func_(func), evaluationCount(0), hitCount(0), evaluationTime(0.0), timing(false) {}
 
     
     double operator()(double x) const override {
-        int bin = static_cast<int>(std::round(x / tol));
+        std::uint64_t bin = cacheKey(x, CacheKeyMode::Quantized, tol);
         auto it = cache_.find(bin);  
         if (it != cache_.end()) {
-            std::cout << "Cache hit for x = " << x << ", returning cached result." << std::endl;
+            hitCount++;
+            TRACE(TraceLevel::Debug, "cache_hit", x, it->second);
             return it->second; 
         }
-        double result = func_(x); 
+        double result;
+        if (timing) {
+            // Two clock reads per real evaluation; only paid while timing
+            auto start = std::chrono::steady_clock::now();
+            result = func_(x);
+            evaluationTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        } else {
+            result = func_(x);
+        }
         cache_[bin] = result;  
         evaluationCount++;  
-        std::cout << "Evaluating function at x = " << x << ", result = " << result << std::endl;
-        std::cout << "Updated evaluation count: " << evaluationCount << std::endl;
+        TRACE(TraceLevel::Debug, "evaluate", x, result);
         return result;
     }
 
 
-    void resetEvaluations() { evaluationCount = 0; }
+    void resetEvaluations() { evaluationCount = 0; hitCount = 0; evaluationTime = 0.0; }
     void clearCache() const { cache_.clear(); }
     int getEvaluationCount() const { return evaluationCount; }
+    int getHitCount() const { return hitCount; }
+
+    // Time spent in the wrapped function, measured while timing is enabled
+    void setTiming(bool enabled) { timing = enabled; }
+    bool isTiming() const { return timing; }
+    double getEvaluationTime() const { return evaluationTime; }
 };
 
-// FastCachedFunction class with basic integer binning for fast lookups
+// FastCachedFunction: thread-safe memoization in a sharded table, so one
+// instance can be shared by the threads of a parallel integrator and reuse
+// the endpoint evaluations that neighbouring subintervals have in common
 class FastCachedFunction : public Function {
 private:
     MathFunction func_;  // Underlying mathematical function
-    mutable std::unordered_map<int, double> cache_;  // Cache with integer bins
-    double tol_;  // Tolerance for binning
-
-    // Converts x to an integer bin index based on tolerance
-    int getBin(double x) const {
-        return static_cast<int>(std::round(x / tol_));
-    }
+    mutable ShardedCache cache_;  // Lock-striped cache with 64-bit keys
+    double tol_;  // Bin width for CacheKeyMode::Quantized
+    CacheKeyMode mode_;
 
 public:
-    // Constructor accepts a MathFunction and tolerance
-    FastCachedFunction(MathFunction func, double tol = 1e-7) : func_(func), tol_(tol) {
+    // Constructor accepts a MathFunction, bin width and key mode
+    FastCachedFunction(MathFunction func, double tol = 1e-7, CacheKeyMode mode = CacheKeyMode::Quantized)
+        : func_(func), tol_(tol), mode_(mode) {
         uses_cache = true;
     }
 
     // Override operator() to include caching with bins
     double operator()(double x) const override {
-        int bin = getBin(x);
-        auto it = cache_.find(bin);
-        if (it != cache_.end()) {
-            return it->second;  // Return cached result if it exists
-        }
-        double result = func_(x);  // Otherwise, evaluate and cache result
-        cache_[bin] = result;
-        count++;
-        return result;
+        return cache_.getOrCompute(cacheKey(x, mode_, tol_), [&]() {
+            count++;
+            return func_(x);
+        });
     }
 
-    // Clears the cache
+    // Clears the cache and its hit/miss counters
     void clearCache() const override { cache_.clear(); }
+
+    CacheStats getCacheStats() const { return cache_.stats(); }
+    size_t getCacheSize() const { return cache_.size(); }
 };
 
 #endif // __DEFINITIONS__H__
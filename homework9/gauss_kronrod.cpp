@@ -0,0 +1,187 @@
+// gauss_kronrod.cpp
+// Globally adaptive Gauss-Kronrod quadrature (G7-K15 and G10-K21).
+#include "integration_methods.h"
+#include "worker_team.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <queue>
+#include <vector>
+
+namespace {
+
+// Abscissae and weights from QUADPACK (qk15, qk21). Kronrod nodes are
+// listed from the outside in; the Gauss nodes are every other one.
+const double xgk15[8] = {
+    0.991455371120812639206854697526329, 0.949107912342758524526189684047851,
+    0.864864423359769072789712788640926, 0.741531185599394439863864773280788,
+    0.586087235467691130294144845693013, 0.405845151377397166906606412076961,
+    0.207784955007898467600689403773245, 0.000000000000000000000000000000000};
+const double wgk15[8] = {
+    0.022935322010529224963732008058970, 0.063092092629978553290700663189204,
+    0.104790010322250183839876322541518, 0.140653259715525918745189590510238,
+    0.169004726639267902826583426598550, 0.190350578064785409913256402421014,
+    0.204432940075298892414161999234649, 0.209482141084727828012999174891714};
+const double wg7[4] = {
+    0.129484966168869693270611432679082, 0.279705391489276667901467771423780,
+    0.381830050505118944950369775488975, 0.417959183673469387755102040816327};
+
+const double xgk21[11] = {
+    0.995657163025808080735527280689003, 0.973906528517171720077964012084452,
+    0.930157491355708226001207180059508, 0.865063366688984510732096688423493,
+    0.780817726586416897063717578345042, 0.679409568299024406234327365114874,
+    0.562757134668604683339000099272694, 0.433395394129247190799265943165784,
+    0.294392862701460198131126603103866, 0.148874338981631210884826001129720,
+    0.000000000000000000000000000000000};
+const double wgk21[11] = {
+    0.011694638867371874278064396062192, 0.032558162307964727478818972459390,
+    0.054755896574351996031381300244580, 0.075039674810919952767043140916190,
+    0.093125454583697605535065465083366, 0.109387158802297641899210590325805,
+    0.123491976262065851077958109831074, 0.134709217311473325928054001771707,
+    0.142775938577060080797094273138717, 0.147739104901338491374841515972068,
+    0.149445554002916905664936468389821};
+const double wg10[5] = {
+    0.066671344308688137593568809893332, 0.149451349150580593145776339657697,
+    0.219086362515982043995534934228163, 0.269266719309996355091226921569469,
+    0.295524224714752870173892994651338};
+
+// One subinterval with its Kronrod estimate and error estimate
+struct Segment {
+    double a, b;
+    double result;
+    double error;
+
+    // Ordered by error so the priority queue pops the worst segment first
+    bool operator<(const Segment& other) const { return error < other.error; }
+};
+
+// Applies one Gauss-Kronrod pair on [a, b] and estimates its error the way
+// QUADPACK does: |K - G| rescaled by the variation of f on the segment.
+Segment applyRule(const MathFunction& f, double a, double b, GaussKronrodRule rule) {
+    const bool k21 = (rule == GaussKronrodRule::G10K21);
+    const int n = k21 ? 11 : 8;            // Kronrod nodes per half, centre included
+    const double* xgk = k21 ? xgk21 : xgk15;
+    const double* wgk = k21 ? wgk21 : wgk15;
+    const double* wg = k21 ? wg10 : wg7;
+
+    double center = 0.5 * (a + b);
+    double half = 0.5 * (b - a);
+
+    double fc = f(center);
+    double resk = fc * wgk[n - 1];
+    double resg = k21 ? 0.0 : fc * wg[3];  // G7 has a centre node, G10 does not
+    double resabs = std::abs(resk);
+
+    double fv1[10], fv2[10];
+    for (int j = 0; j < n - 1; ++j) {
+        double dx = half * xgk[j];
+        double f1 = f(center - dx);
+        double f2 = f(center + dx);
+        fv1[j] = f1;
+        fv2[j] = f2;
+        resk += wgk[j] * (f1 + f2);
+        resabs += wgk[j] * (std::abs(f1) + std::abs(f2));
+        if (j % 2 == 1)
+            resg += wg[j / 2] * (f1 + f2);
+    }
+
+    double reskh = 0.5 * resk;
+    double resasc = wgk[n - 1] * std::abs(fc - reskh);
+    for (int j = 0; j < n - 1; ++j)
+        resasc += wgk[j] * (std::abs(fv1[j] - reskh) + std::abs(fv2[j] - reskh));
+
+    double result = resk * half;
+    resabs *= std::abs(half);
+    resasc *= std::abs(half);
+    double error = std::abs((resk - resg) * half);
+
+    const double epmach = std::numeric_limits<double>::epsilon();
+    const double uflow = std::numeric_limits<double>::min();
+    if (resasc != 0.0 && error != 0.0)
+        error = resasc * std::min(1.0, std::pow(200.0 * error / resasc, 1.5));
+    if (resabs > uflow / (50.0 * epmach))
+        error = std::max(50.0 * epmach * resabs, error);
+
+    return Segment{a, b, result, error};
+}
+
+} // namespace
+
+int gaussKronrodPoints(GaussKronrodRule rule) {
+    return rule == GaussKronrodRule::G10K21 ? 21 : 15;
+}
+
+// Globally adaptive Gauss-Kronrod integration.
+// All segments live in a priority queue keyed on their error estimate.
+// Each round pops the k worst segments (k = numThreads), bisects them and
+// evaluates the 2k halves in parallel, until the summed error drops below
+// tol or maxIntervals segments exist. The worker threads are started once
+// per call and reused by every round. Parallel rounds require f to be safe
+// to call from several threads at once.
+GaussKronrodResult gaussKronrodAdaptive(const MathFunction& f, double a, double b, double tol,
+                                        int maxIntervals, GaussKronrodRule rule, int numThreads) {
+    const int points = gaussKronrodPoints(rule);
+    numThreads = std::max(1, numThreads);
+
+    std::priority_queue<Segment> segments;
+    Segment whole = applyRule(f, a, b, rule);
+    segments.push(whole);
+
+    double total = whole.result;
+    double totalError = whole.error;
+    int evaluations = points;
+
+    WorkerTeam team(numThreads);
+    std::vector<Segment> worst;
+    std::vector<Segment> halves;
+    while (totalError > tol && static_cast<int>(segments.size()) < maxIntervals) {
+        int k = std::min<int>(numThreads, maxIntervals - static_cast<int>(segments.size()));
+        k = std::max(1, std::min<int>(k, static_cast<int>(segments.size())));
+
+        worst.clear();
+        for (int i = 0; i < k; ++i) {
+            worst.push_back(segments.top());
+            segments.pop();
+        }
+
+        halves.assign(2 * worst.size(), Segment());
+        auto refine = [&](size_t i) {
+            const Segment& s = worst[i];
+            double mid = 0.5 * (s.a + s.b);
+            halves[2 * i] = applyRule(f, s.a, mid, rule);
+            halves[2 * i + 1] = applyRule(f, mid, s.b, rule);
+        };
+
+        if (worst.size() == 1) {
+            refine(0);
+        } else {
+            team.run([&](int t) {
+                for (size_t i = t; i < worst.size(); i += team.size())
+                    refine(i);
+            });
+        }
+
+        for (size_t i = 0; i < worst.size(); ++i) {
+            total -= worst[i].result;
+            totalError -= worst[i].error;
+        }
+        for (const Segment& h : halves) {
+            total += h.result;
+            totalError += h.error;
+            segments.push(h);
+        }
+        evaluations += 2 * points * static_cast<int>(worst.size());
+    }
+
+    // Re-sum from the segments to drop the drift of the running updates
+    total = 0.0;
+    totalError = 0.0;
+    int intervals = static_cast<int>(segments.size());
+    while (!segments.empty()) {
+        total += segments.top().result;
+        totalError += segments.top().error;
+        segments.pop();
+    }
+
+    return GaussKronrodResult{total, totalError, evaluations, intervals, totalError <= tol};
+}
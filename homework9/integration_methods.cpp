@@ -1,9 +1,11 @@
 // integration_utils.cpp
 #include "integration_methods.h"
+#include "static_integration.h"
 #include <unordered_map>
 #include <functional>
 #include <vector>
 #include <cmath>
+#include <algorithm>
 using MathFunction = std::function<double(double)>;
 
 // Basic Trapezoidal rule
@@ -20,126 +22,198 @@ double basicSimpson(const MathFunction& f, double a, double b) {
 
 // Non-recursive trapezoidal rule
 double trapezoidalNonRecursive(const MathFunction& f, double a, double b, int n_intervals) {
-    double h = (b - a) / n_intervals;
-    double sum = 0.5 * (f(a) + f(b));
-
-    for (int i = 1; i < n_intervals; i++) {
-        double x = a + i * h;
-        sum += f(x);
-    }
-
-    return h * sum;
+    return compositeClosed<TrapezoidRule>(f, a, b, n_intervals);
 }
 
-// Non-recursive Simpson's rule
+// Non-recursive Simpson's rule (an odd interval count is rounded up)
 double simpsonNonRecursive(const MathFunction& f, double a, double b, int n_intervals) {
-    int n = n_intervals;
-    if (n % 2 != 0) n++;
-
-    double h = (b - a) / n;
-    double sum = f(a) + f(b);
+    return compositeClosed<SimpsonRule>(f, a, b, n_intervals);
+}
 
-    for (int i = 1; i < n; i++) {
-        double x = a + i * h;
-        sum += (i % 2 == 0) ? 2 * f(x) : 4 * f(x);
+// Composite closed rule with the accumulation policy picked at run time
+template<class Rule>
+static double compositeClosedWith(const MathFunction& f, double a, double b, int n_intervals, Summation summation) {
+    switch (summation) {
+    case Summation::Neumaier:
+        return compositeClosed<Rule, NeumaierSum>(f, a, b, n_intervals);
+    case Summation::Pairwise:
+        return compositeClosed<Rule, PairwiseSum>(f, a, b, n_intervals);
+    case Summation::DoubleDouble:
+        return compositeClosed<Rule, DoubleDoubleSum>(f, a, b, n_intervals);
+    default:
+        return compositeClosed<Rule, NaiveSum>(f, a, b, n_intervals);
     }
+}
 
-    return h * sum / 3;
+double trapezoidalNonRecursive(const MathFunction& f, double a, double b, int n_intervals, Summation summation) {
+    return compositeClosedWith<TrapezoidRule>(f, a, b, n_intervals, summation);
 }
 
-// Recursive adaptive trapezoidal rule
+double simpsonNonRecursive(const MathFunction& f, double a, double b, int n_intervals, Summation summation) {
+    return compositeClosedWith<SimpsonRule>(f, a, b, n_intervals, summation);
+}
+
+// Recursive adaptive trapezoidal rule: the engine with tol halved per
+// level; a call at depth has maxDepth - depth levels left
 double adaptiveTrapezoidalRecursive(const MathFunction& f, double a, double b, double tol, int maxDepth, int depth) {
+    return adaptiveIntegrate(f, a, b, tol, maxDepth - depth, AdaptiveRule::Trapezoid,
+                             TolerancePolicy::HalvePerLevel).value;
+}
+
+// Recursive adaptive Simpson's rule
+double adaptiveSimpsonRecursive(const MathFunction& f, double a, double b, double tol, int maxDepth, int depth) {
+    return adaptiveIntegrate(f, a, b, tol, maxDepth - depth, AdaptiveRule::Simpson,
+                             TolerancePolicy::HalvePerLevel).value;
+}
+
+// Non-adaptive recursive trapezoidal rule: splits every interval until
+// maxDepth, so the result is the composite rule on 2^maxDepth panels
+double trapezoidalUniformRecursive(const MathFunction& f, double a, double b, int maxDepth, int depth) {
     if (depth >= maxDepth) {
         return basicTrapezoidal(f, a, b);
     }
-
     double c = (a + b) / 2;
-    double one_trap = basicTrapezoidal(f, a, b);
-    double two_trap = basicTrapezoidal(f, a, c) + basicTrapezoidal(f, c, b);
-    double error = std::abs(two_trap - one_trap);
-
-    if (error < tol) {
-        return two_trap;
-    }
-
-    return adaptiveTrapezoidalRecursive(f, a, c, tol / 2, maxDepth, depth + 1) +
-           adaptiveTrapezoidalRecursive(f, c, b, tol / 2, maxDepth, depth + 1);
+    return trapezoidalUniformRecursive(f, a, c, maxDepth, depth + 1) +
+           trapezoidalUniformRecursive(f, c, b, maxDepth, depth + 1);
 }
 
-// Recursive adaptive Simpson's rule
-double adaptiveSimpsonRecursive(const MathFunction& f, double a, double b, double tol, int maxDepth, int depth) {
+// Non-adaptive recursive Simpson's rule on 2^maxDepth panels
+double simpsonUniformRecursive(const MathFunction& f, double a, double b, int maxDepth, int depth) {
     if (depth >= maxDepth) {
         return basicSimpson(f, a, b);
     }
-
     double c = (a + b) / 2;
-    double fa = f(a), fb = f(b), fc = f(c);
-    double whole = (b - a) * (fa + 4 * fc + fb) / 6;
-    double left = (c - a) * (fa + 4 * f((a + c) / 2) + fc) / 6;
-    double right = (b - c) * (fc + 4 * f((c + b) / 2) + fb) / 6;
-    double error = std::abs(left + right - whole);
-
-    if (error < tol) {
-        return left + right;
-    }
-
-    return adaptiveSimpsonRecursive(f, a, c, tol / 2, maxDepth, depth + 1) +
-           adaptiveSimpsonRecursive(f, c, b, tol / 2, maxDepth, depth + 1);
+    return simpsonUniformRecursive(f, a, c, maxDepth, depth + 1) +
+           simpsonUniformRecursive(f, c, b, maxDepth, depth + 1);
 }
 
-// Non-recursive adaptive trapezoidal rule
+// Non-recursive adaptive trapezoidal rule: the engine with the same
+// tolerance on every interval
 double adaptiveTrapezoidalNonRecursive(const MathFunction& f, double a, double b, double tolerance, int max_depth) {
-    std::vector<Interval> intervals;
-    double total_area = 0.0;
+    return adaptiveIntegrate(f, a, b, tolerance, max_depth, AdaptiveRule::Trapezoid, TolerancePolicy::Constant).value;
+}
 
-    double fa = f(a), fb = f(b);
-    intervals.push_back({a, b, fa, fb, 0.5 * (b - a) * (fa + fb), 0});
+double adaptiveTrapezoidalNonRecursive(const MathFunction& f, double a, double b, double tolerance, int max_depth,
+                                       AdaptiveWorkspace& workspace) {
+    return adaptiveIntegrate(f, a, b, tolerance, max_depth, AdaptiveRule::Trapezoid, TolerancePolicy::Constant,
+                             workspace).value;
+}
 
-    while (!intervals.empty()) {
-        Interval interval = intervals.back();
-        intervals.pop_back();
+// Kept under its historical name; the same bisection as adaptiveSimpsonRecursive
+double simpsonNonAdaptiveRecursive(const MathFunction& f, double a, double b, double tol, int maxDepth, int depth) {
+    return adaptiveIntegrate(f, a, b, tol, maxDepth - depth, AdaptiveRule::Simpson,
+                             TolerancePolicy::HalvePerLevel).value;
+}
+
+// Explicit-stack engine behind the adaptive trapezoid and Simpson methods.
+// Intervals are processed depth first, left half first, which is the order
+// the recursive functions visit them in. Each interval keeps f at its ends
+// (and at its midpoint for Simpson), so a child never re-evaluates what its
+// parent already computed.
+AdaptiveResult adaptiveIntegrate(const MathFunction& f, double a, double b, double tol, int maxDepth,
+                                 AdaptiveRule rule, TolerancePolicy policy, AdaptiveWorkspace& ws) {
+    ws.reserve(maxDepth);
+    const bool simpson = (rule == AdaptiveRule::Simpson);
+    AdaptiveResult result{0.0, 0, 0, 0, 0.0};
+    // Richardson: the error of the refined estimate is |refined - coarse| / (2^order - 1)
+    const double richardson = simpson ? 15.0 : 3.0;
+
+    size_t top = 0;
+    auto push = [&](const Interval& in, double intervalTol) {
+        ws.a[top] = in.a;
+        ws.b[top] = in.b;
+        ws.fa[top] = in.fa;
+        ws.fb[top] = in.fb;
+        ws.fm[top] = in.fm;
+        ws.area[top] = in.area;
+        ws.tol[top] = intervalTol;
+        ws.depth[top] = in.depth;
+        ++top;
+    };
 
-        if (interval.depth >= max_depth) {
-            total_area += interval.area;
+    double fa = f(a), fb = f(b);
+    double fm = simpson ? f((a + b) / 2) : 0.0;
+    result.evaluations = simpson ? 3 : 2;
+    double area = simpson ? (b - a) * (fa + 4 * fm + fb) / 6 : 0.5 * (b - a) * (fa + fb);
+
+    push({a, b, fa, fb, fm, area, 0}, tol);
+    while (top > 0) {
+        --top;
+        const Interval in = {ws.a[top], ws.b[top], ws.fa[top], ws.fb[top], ws.fm[top], ws.area[top], ws.depth[top]};
+        const double inTol = ws.tol[top];
+        result.maxDepthReached = std::max(result.maxDepthReached, in.depth);
+
+        if (in.depth >= maxDepth) {
+            result.value += in.area;
+            ++result.truncatedIntervals;
             continue;
         }
 
-        double mid = (interval.a + interval.b) / 2;
-        double f_mid = f(mid);
-
-        Interval left = {interval.a, mid, interval.fa, f_mid, 0.5 * (mid - interval.a) * (interval.fa + f_mid), interval.depth + 1};
-        Interval right = {mid, interval.b, f_mid, interval.fb, 0.5 * (interval.b - mid) * (f_mid + interval.fb), interval.depth + 1};
-
-        double error = std::abs(left.area + right.area - interval.area);
+        double c = (in.a + in.b) / 2;
+        Interval left, right;
+        if (simpson) {
+            double flm = f((in.a + c) / 2);
+            double frm = f((c + in.b) / 2);
+            result.evaluations += 2;
+            left = {in.a, c, in.fa, in.fm, flm, (c - in.a) * (in.fa + 4 * flm + in.fm) / 6, in.depth + 1};
+            right = {c, in.b, in.fm, in.fb, frm, (in.b - c) * (in.fm + 4 * frm + in.fb) / 6, in.depth + 1};
+        } else {
+            double fc = f(c);
+            result.evaluations += 1;
+            left = {in.a, c, in.fa, fc, 0.0, 0.5 * (c - in.a) * (in.fa + fc), in.depth + 1};
+            right = {c, in.b, fc, in.fb, 0.0, 0.5 * (in.b - c) * (fc + in.fb), in.depth + 1};
+        }
 
-        if (error < tolerance) {
-            total_area += left.area + right.area;
+        double difference = std::abs(left.area + right.area - in.area);
+        if (difference < inTol) {
+            result.value += left.area + right.area;
+            result.errorEstimate += difference / richardson;
         } else {
-            intervals.push_back(right);
-            intervals.push_back(left);
+            // Children at maxDepth are accepted unchecked; this is all that
+            // is known about their error
+            if (in.depth + 1 >= maxDepth)
+                result.errorEstimate += difference / richardson;
+            // Children are only pushed below maxDepth, so at most one pending
+            // right half per level is stacked: top stays <= maxDepth + 1
+            double childTol = (policy == TolerancePolicy::HalvePerLevel) ? inTol / 2 : inTol;
+            push(right, childTol);
+            push(left, childTol);
         }
     }
 
-    return total_area;
+    return result;
 }
 
-// Non-recursive adaptive Simpson's rule
-double simpsonNonAdaptiveRecursive(const MathFunction& f, double a, double b, double tol, int maxDepth, int depth) {
-    if (depth >= maxDepth) {
-        return basicSimpson(f, a, b);
-    }
-
-    double c = (a + b) / 2;
-    double fa = f(a), fb = f(b), fc = f(c);
-    double whole = (b - a) * (fa + 4 * fc + fb) / 6;
-    double left = (c - a) * (fa + 4 * f((a + c) / 2) + fc) / 6;
-    double right = (b - c) * (fc + 4 * f((c + b) / 2) + fb) / 6;
-    double error = std::abs(left + right - whole);
-
-    if (error < tol) {
-        return left + right;
+AdaptiveResult adaptiveIntegrate(const MathFunction& f, double a, double b, double tol, int maxDepth,
+                                 AdaptiveRule rule, TolerancePolicy policy) {
+    static thread_local AdaptiveWorkspace workspace;
+    static thread_local bool inUse = false;
+    if (inUse) {
+        AdaptiveWorkspace nested;
+        return adaptiveIntegrate(f, a, b, tol, maxDepth, rule, policy, nested);
     }
+    // Released even if f throws
+    struct Claim {
+        bool& flag;
+        explicit Claim(bool& flag) : flag(flag) { flag = true; }
+        ~Claim() { flag = false; }
+    } claim(inUse);
+    return adaptiveIntegrate(f, a, b, tol, maxDepth, rule, policy, workspace);
+}
 
-    return simpsonNonAdaptiveRecursive(f, a, c, tol / 2, maxDepth, depth + 1) +
-           simpsonNonAdaptiveRecursive(f, c, b, tol / 2, maxDepth, depth + 1);
+void AdaptiveWorkspace::reserve(int maxDepth) {
+    size_t n = static_cast<size_t>(std::max(maxDepth, 0)) + 1;
+    if (n <= capacity_)
+        return;
+    values.assign(7 * n, 0.0);
+    depths.assign(n, 0);
+    a = values.data();
+    b = a + n;
+    fa = b + n;
+    fb = fa + n;
+    fm = fb + n;
+    area = fm + n;
+    tol = area + n;
+    depth = depths.data();
+    capacity_ = n;
 }
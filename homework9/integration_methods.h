@@ -12,6 +12,7 @@ using MathFunction = std::function<double(double)>;
 struct Interval {
     double a, b;    // Interval boundaries
     double fa, fb;  // Function values at boundaries
+    double fm;      // Function value at the midpoint (Simpson only)
     double area;    // Area of the interval
     int depth;      // Depth of recursion
 };
@@ -26,6 +27,14 @@ struct IntegrationResults {
     double analytical_result;           // Analytical result (if available, otherwise -1)
     double absolute_error;              // Absolute error (if available, otherwise -1)
     double execution_time;              // Time taken to perform the integration
+    int function_evaluations;           // Function evaluations (if counted, otherwise -1)
+    double error_estimate;              // Method's own error estimate (if any, otherwise -1)
+    int method_evaluations;             // Calls the method made to f, cache hits included (otherwise -1)
+    double cache_hit_rate;              // Fraction of calls answered by the cache (otherwise -1)
+    int max_depth_reached;              // Deepest bisection or refinement level (otherwise -1)
+    int truncated_intervals;            // Intervals accepted only because max depth was hit (otherwise -1)
+    bool converged;                     // False if the method stopped before reaching its tolerance
+    double evaluation_time;             // Part of execution_time spent evaluating f (otherwise -1)
 
     // Constructor with all fields
     IntegrationResults(const std::string& method, const std::string& func,
@@ -36,7 +45,23 @@ struct IntegrationResults {
           nb_intervals_or_max_depth(intervals_or_depth),
           recursive(is_recursive), numerical_result(num_result),
           analytical_result(anal_result), absolute_error(abs_error),
-          execution_time(0.0) {}
+          execution_time(0.0), function_evaluations(-1), error_estimate(-1), method_evaluations(-1),
+          cache_hit_rate(-1), max_depth_reached(-1), truncated_intervals(-1), converged(true),
+          evaluation_time(-1) {}
+};
+
+// What one run of an Integration did; -1 marks a quantity the method
+// does not have
+struct IntegrationTelemetry {
+    int evaluations = -1;         // Real evaluations of f (cache misses)
+    int methodEvaluations = -1;   // Calls the method made to f, cache hits included
+    double cacheHitRate = -1;     // Cache hits per call
+    int maxDepthReached = -1;     // Deepest bisection level, or refinement level
+    int truncatedIntervals = -1;  // Intervals accepted only because maxDepth was reached
+    double errorEstimate = -1;    // Method's own error estimate
+    bool converged = true;        // False if the method gave up before meeting its tolerance
+    double totalTime = 0.0;       // Seconds for the whole integration
+    double evaluationTime = 0.0;  // Of which inside the integrand; the rest is method and cache overhead
 };
 
 // Function declarations using MathFunction alias
@@ -46,10 +71,193 @@ double basicSimpson(const MathFunction& f, double a, double b);
 double trapezoidalNonRecursive(const MathFunction& f, double a, double b, int n_intervals);
 double simpsonNonRecursive(const MathFunction& f, double a, double b, int n_intervals);
 
+// Accumulation policy of the composite rules (see accumulation.h)
+enum class Summation { Naive, Neumaier, Pairwise, DoubleDouble };
+
+double trapezoidalNonRecursive(const MathFunction& f, double a, double b, int n_intervals, Summation summation);
+double simpsonNonRecursive(const MathFunction& f, double a, double b, int n_intervals, Summation summation);
+
+// Adaptive bisection with tol halved per level, run on adaptiveIntegrate
 double adaptiveTrapezoidalRecursive(const MathFunction& f, double a, double b, double tol, int maxDepth, int depth);
 double adaptiveSimpsonRecursive(const MathFunction& f, double a, double b, double tol, int maxDepth, int depth);
 
+// Non-adaptive recursive rules: bisect down to maxDepth everywhere (2^maxDepth panels), no error test
+double trapezoidalUniformRecursive(const MathFunction& f, double a, double b, int maxDepth, int depth);
+double simpsonUniformRecursive(const MathFunction& f, double a, double b, int maxDepth, int depth);
+
+class AdaptiveWorkspace;
+
 double adaptiveTrapezoidalNonRecursive(const MathFunction& f, double a, double b, double tolerance, int max_depth);
+double adaptiveTrapezoidalNonRecursive(const MathFunction& f, double a, double b, double tolerance, int max_depth,
+                                       AdaptiveWorkspace& workspace);
 double simpsonNonAdaptiveRecursive(const MathFunction& f, double a, double b, double tol, int maxDepth, int depth);
 
+// Adaptive bisection on one explicit-stack engine. Every interval carries
+// the function values its parent already computed, so each bisection costs
+// one new evaluation (trapezoid) or two (Simpson).
+enum class AdaptiveRule { Trapezoid, Simpson };
+
+// How the tolerance is split between the two halves of an interval
+enum class TolerancePolicy {
+    HalvePerLevel,  // tol / 2 per level, as the recursive methods do
+    Constant        // Same tol everywhere, as the non-recursive methods do
+};
+
+struct AdaptiveResult {
+    double value;            // Integral estimate
+    int evaluations;         // Calls to f
+    int maxDepthReached;     // Deepest level processed
+    int truncatedIntervals;  // Intervals accepted only because maxDepth was reached
+    double errorEstimate;    // Richardson estimate summed over the accepted intervals
+};
+
+// Interval stack of adaptiveIntegrate, stored column-wise in one block.
+// Depth-first refinement never holds more than maxDepth + 1 intervals, so
+// the block is sized once from maxDepth; reusing a workspace for later
+// integrals of the same or smaller depth allocates nothing.
+class AdaptiveWorkspace {
+public:
+    AdaptiveWorkspace() = default;
+    explicit AdaptiveWorkspace(int maxDepth) { reserve(maxDepth); }
+    AdaptiveWorkspace(const AdaptiveWorkspace&) = delete;
+    AdaptiveWorkspace& operator=(const AdaptiveWorkspace&) = delete;
+
+    // Makes room for a refinement down to maxDepth
+    void reserve(int maxDepth);
+    size_t capacity() const { return capacity_; }
+
+    // Columns, one entry per stacked interval
+    double* a = nullptr;
+    double* b = nullptr;
+    double* fa = nullptr;
+    double* fb = nullptr;
+    double* fm = nullptr;    // Midpoint value (Simpson only)
+    double* area = nullptr;
+    double* tol = nullptr;
+    int* depth = nullptr;
+
+private:
+    std::vector<double> values;
+    std::vector<int> depths;
+    size_t capacity_ = 0;
+};
+
+// Uses a per-thread workspace (or a temporary one when called from inside
+// an integrand that is itself being integrated on this thread)
+AdaptiveResult adaptiveIntegrate(const MathFunction& f, double a, double b, double tol, int maxDepth,
+                                 AdaptiveRule rule, TolerancePolicy policy);
+AdaptiveResult adaptiveIntegrate(const MathFunction& f, double a, double b, double tol, int maxDepth,
+                                 AdaptiveRule rule, TolerancePolicy policy, AdaptiveWorkspace& workspace);
+
+// Gauss-Kronrod rule pairs: Gauss points embedded in the Kronrod points
+enum class GaussKronrodRule { G7K15, G10K21 };
+
+struct GaussKronrodResult {
+    double value;         // Integral estimate
+    double error;         // Estimated absolute error
+    int evaluations;      // Function evaluations
+    int intervals;        // Subintervals in the final partition
+    bool converged;       // Whether error <= tol was reached before maxIntervals
+};
+
+int gaussKronrodPoints(GaussKronrodRule rule);
+GaussKronrodResult gaussKronrodAdaptive(const MathFunction& f, double a, double b, double tol, int maxIntervals,
+                                        GaussKronrodRule rule = GaussKronrodRule::G7K15, int numThreads = 1);
+
+// Evaluates f at x[0..n) into fx[0..n); lets integrands vectorise over a batch
+using BatchFunction = std::function<void(const double* x, double* fx, int n)>;
+
+struct DoubleExponentialResult {
+    double value;         // Integral estimate
+    double error;         // Difference between the last two levels
+    int evaluations;      // Function evaluations
+    int levels;           // Refinement levels used (step 2^-levels)
+    bool converged;       // Whether error <= tol was reached before the finest level
+};
+
+// Tanh-sinh quadrature; never evaluates f at a or b, so endpoint singularities are fine
+DoubleExponentialResult doubleExponential(const MathFunction& f, double a, double b, double tol);
+DoubleExponentialResult doubleExponentialBatch(const BatchFunction& f, double a, double b, double tol);
+
+struct RombergResult {
+    double value;         // Extrapolated estimate (diagonal of the Romberg tableau)
+    double trapezoid;     // Plain trapezoid sum on the finest level
+    double error;         // Difference between the last two diagonal entries
+    int evaluations;      // Function evaluations (2^levels + 1)
+    int levels;           // Refinement levels used (2^levels intervals)
+    bool converged;       // Whether error <= tol was reached before maxLevels
+};
+
+// Nested trapezoid refinement with Romberg extrapolation; each level reuses the previous sum
+RombergResult romberg(const MathFunction& f, double a, double b, double tol, int maxLevels);
+
+// Oscillatory integrands g(x) * sin(omega x) or g(x) * cos(omega x)
+enum class OscillatorKind { Sin, Cos };
+
+// Which engine integrateOscillatory picked
+enum class OscillatoryMethod {
+    Filon,           // Chebyshev interpolation of g, oscillator integrated exactly; picked
+                     // automatically when the zeros of f are evenly spaced
+    ZeroCrossings,   // Black-box f split at its sign changes, Gauss-Kronrod per panel
+    GaussKronrod     // Not oscillatory: plain adaptive G10-K21
+};
+
+struct OscillatoryResult {
+    double value;              // Integral estimate
+    double error;              // Estimated absolute error
+    int evaluations;           // Calls to f (or g), detection samples included
+    int panels;                // Panels of the final partition
+    bool converged;            // Whether error <= tol was reached
+    OscillatoryMethod method;
+};
+
+// Sign changes of f on a uniform grid; the grid is refined (reusing every
+// sample) until there are at least 8 samples per sign change or maxSamples
+// is reached
+struct OscillationEstimate {
+    std::vector<double> x, fx;  // The final grid and f on it
+    int signChanges;
+    bool oscillatory;           // At least minSignChanges sign changes
+};
+
+OscillationEstimate detectOscillation(const MathFunction& f, double a, double b, int minSignChanges = 16,
+                                      int maxSamples = 1 << 20);
+
+// Filon-Clenshaw-Curtis: integral of g(x) * sin/cos(omega x) on [a, b].
+// g is interpolated at the Chebyshev points of equal panels and the moments
+// of the oscillator are computed once per panel width, so the cost depends
+// on the smoothness of g, not on omega. Panels double until two estimates
+// agree to within tol.
+OscillatoryResult filonIntegrate(const MathFunction& g, double omega, OscillatorKind kind, double a, double b,
+                                 double tol, int maxPanels = 1 << 12);
+
+// Black-box routing. Detects oscillation; if the zeros of f are evenly
+// spaced (f = g(x) * sin(omega x + phase) with g free of zeros), omega and
+// the phase are fitted to a few refined zeros and g = f / sin(omega x +
+// phase) goes to Filon. Otherwise, or if Filon does not converge within a
+// few panel doublings, [a, b] is split at the sign changes of f (two per
+// panel) and G10-K21 runs on each panel. Without oscillation, adaptive
+// G10-K21 runs on the whole interval.
+OscillatoryResult integrateOscillatory(const MathFunction& f, double a, double b, double tol);
+
+// Vector-valued integrand: writes its components at x into values[0..components)
+using VectorFunction = std::function<void(double x, double* values)>;
+
+struct VectorAdaptiveResult {
+    std::vector<double> values;  // Integral estimate per component
+    std::vector<double> errors;  // Richardson estimate per component
+    int evaluations;             // Calls to f, each giving every component
+    int maxDepthReached;         // Deepest level processed
+    int truncatedIntervals;      // Intervals accepted only because maxDepth was reached
+};
+
+// adaptiveIntegrate for all components of f at once, on one shared
+// refinement tree. An interval is accepted when the largest component
+// difference (max norm) is below its tolerance, so every component meets the
+// test the scalar engine would apply to it alone. Per-interval values are
+// stored component-contiguous and the rule is applied in plain loops over
+// the components, which the compiler vectorises (gcc at -O3).
+VectorAdaptiveResult adaptiveIntegrateVector(const VectorFunction& f, int components, double a, double b,
+                                             double tol, int maxDepth, AdaptiveRule rule, TolerancePolicy policy);
+
 #endif // INTEGRATION_METHODS_H
@@ -1,6 +1,9 @@
 #include <chrono>
 #include "definitions.h"
 #include "integration_methods.h"
+#include "bounded_cache.h"
+#include "static_integration.h"
+#include "chebyshev_surrogate.h"
 #include <stdexcept>
 #include <iostream>
 #include <vector>
@@ -9,6 +12,8 @@
 #include <limits>
 #include <unordered_map>
 #include <functional>
+#include <cstdlib>
+#include <thread>
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
@@ -20,6 +25,21 @@ protected:
     bool isRecursive, isAdaptive;
     double timeTaken;
     double lastResult;
+    IntegrationTelemetry telemetry;  // Subclasses fill in what their method knows
+
+    // Depth and truncation of an adaptive bisection run; truncation is
+    // reported, since it means tolerance was not met everywhere
+    void recordAdaptive(const AdaptiveResult& r, const char* method, int maxDepth) {
+        telemetry.methodEvaluations = r.evaluations;
+        telemetry.maxDepthReached = r.maxDepthReached;
+        telemetry.truncatedIntervals = r.truncatedIntervals;
+        telemetry.errorEstimate = r.errorEstimate;
+        telemetry.converged = (r.truncatedIntervals == 0);
+        if (r.truncatedIntervals > 0) {
+            std::cerr << "Warning: " << method << " accepted " << r.truncatedIntervals
+                      << " intervals at max depth " << maxDepth << " without meeting the tolerance" << std::endl;
+        }
+    }
 
 public:
     Integration(double lowerBound, double upperBound, bool recursive, bool adaptive)
@@ -30,18 +50,40 @@ public:
     double getA() const { return a; }
     double getB() const { return b; }
 
+    // Implementations pass std::cref(func) to the integration routines, so
+    // evaluations are counted and cached on func itself rather than on a copy
     virtual double integrate(CachedFunction& func) = 0;
 
+    // Runs the method and records its telemetry; the counters of func are
+    // read as differences, so func may be shared between runs
     double operator()(CachedFunction& func) {
+        telemetry = IntegrationTelemetry();
+        int missesBefore = func.getEvaluationCount();
+        int hitsBefore = func.getHitCount();
+        double evaluationTimeBefore = func.getEvaluationTime();
+        bool wasTiming = func.isTiming();
+        func.setTiming(true);
+
         auto start = std::chrono::high_resolution_clock::now();
         lastResult = integrate(func);
         auto end = std::chrono::high_resolution_clock::now();
         timeTaken = std::chrono::duration<double>(end - start).count();
+
+        func.setTiming(wasTiming);
+        int hits = func.getHitCount() - hitsBefore;
+        telemetry.evaluations = func.getEvaluationCount() - missesBefore;
+        telemetry.cacheHitRate = (hits + telemetry.evaluations > 0)
+                                     ? static_cast<double>(hits) / (hits + telemetry.evaluations) : 0.0;
+        telemetry.totalTime = timeTaken;
+        telemetry.evaluationTime = func.getEvaluationTime() - evaluationTimeBefore;
         return lastResult;
     }
 
     double getTimeTaken() const { return timeTaken; }
     double getLastResult() const { return lastResult; }
+    double getErrorEstimate() const { return telemetry.errorEstimate; }
+    int getMethodEvaluations() const { return telemetry.methodEvaluations; }
+    const IntegrationTelemetry& getTelemetry() const { return telemetry; }
 };
 
 class NonAdaptiveIntegration : public Integration {
@@ -53,7 +95,8 @@ public:
         : Integration(lowerBound, upperBound, recursive, false), numIntervals(intervals) {}
 
     double integrate(CachedFunction& func) override {
-        return simpsonNonRecursive(func, a, b, numIntervals);
+        telemetry.methodEvaluations = numIntervals + (numIntervals % 2 != 0) + 1;
+        return compositeClosed<SimpsonRule>(func, a, b, numIntervals);
     }
 };
 
@@ -67,7 +110,10 @@ public:
         : Integration(lowerBound, upperBound, recursive, true), tolerance(tol), maxDepth(maxDepth) {}
 
     double integrate(CachedFunction& func) override {
-        return adaptiveSimpsonRecursive(func, a, b, tolerance, maxDepth, 0);
+        AdaptiveResult r = adaptiveIntegrate(std::cref(func), a, b, tolerance, maxDepth, AdaptiveRule::Simpson,
+                                             isRecursive ? TolerancePolicy::HalvePerLevel : TolerancePolicy::Constant);
+        recordAdaptive(r, "adaptive Simpson", maxDepth);
+        return r.value;
     }
 };
 
@@ -77,7 +123,8 @@ public:
         : Integration(a, b, recursive, false), numIntervals(numIntervals) {}
 
     double integrate(CachedFunction& func) override {
-        return trapezoidalNonRecursive(func, a, b, numIntervals);
+        telemetry.methodEvaluations = numIntervals + 1;
+        return compositeClosed<TrapezoidRule>(func, a, b, numIntervals);
     }
 
 private:
@@ -89,8 +136,13 @@ public:
     AdaptiveTrapezoidal(double a, double b, bool recursive, double tol, int maxDepth)
         : Integration(a, b, recursive, true), tolerance(tol), maxDepth(maxDepth) {}
 
+    // Recursive and non-recursive variants share one engine and differ only
+    // in how the tolerance is split between the halves
     double integrate(CachedFunction& func) override {
-        return adaptiveTrapezoidalRecursive(func, a, b, tolerance, maxDepth, 0);
+        AdaptiveResult r = adaptiveIntegrate(std::cref(func), a, b, tolerance, maxDepth, AdaptiveRule::Trapezoid,
+                                             isRecursive ? TolerancePolicy::HalvePerLevel : TolerancePolicy::Constant);
+        recordAdaptive(r, "adaptive trapezoidal", maxDepth);
+        return r.value;
     }
 
 private:
@@ -104,7 +156,8 @@ public:
         : Integration(a, b, recursive, false), numIntervals(numIntervals) {}
 
     double integrate(CachedFunction& func) override {
-        return simpsonNonRecursive(func, a, b, numIntervals);
+        telemetry.methodEvaluations = numIntervals + (numIntervals % 2 != 0) + 1;
+        return compositeClosed<SimpsonRule>(func, a, b, numIntervals);
     }
 
 private:
@@ -117,7 +170,10 @@ public:
         : Integration(a, b, recursive, true), tolerance(tol), maxDepth(maxDepth) {}
 
     double integrate(CachedFunction& func) override {
-        return adaptiveSimpsonRecursive(func, a, b, tolerance, maxDepth, 0);
+        AdaptiveResult r = adaptiveIntegrate(std::cref(func), a, b, tolerance, maxDepth, AdaptiveRule::Simpson,
+                                             isRecursive ? TolerancePolicy::HalvePerLevel : TolerancePolicy::Constant);
+        recordAdaptive(r, "adaptive Simpson", maxDepth);
+        return r.value;
     }
 
 private:
@@ -125,6 +181,112 @@ private:
     int maxDepth;
 };
 
+// Globally adaptive Gauss-Kronrod: always refines the segment with the
+// largest error estimate, so the error budget is spent where it matters
+class GaussKronrod : public Integration {
+public:
+    GaussKronrod(double a, double b, double tol, int maxIntervals,
+                 GaussKronrodRule rule = GaussKronrodRule::G7K15, int numThreads = 1)
+        : Integration(a, b, false, true), tolerance(tol), maxIntervals(maxIntervals), rule(rule), numThreads(numThreads) {
+        // CachedFunction's table and counters are not synchronised
+        if (numThreads > 1)
+            throw std::invalid_argument("GaussKronrod evaluates a CachedFunction, which is not thread-safe; "
+                                        "numThreads must be 1");
+    }
+
+    double integrate(CachedFunction& func) override {
+        GaussKronrodResult r = gaussKronrodAdaptive(std::cref(func), a, b, tolerance, maxIntervals, rule, numThreads);
+        telemetry.errorEstimate = r.error;
+        telemetry.methodEvaluations = r.evaluations;
+        telemetry.converged = r.converged;
+        if (!r.converged) {
+            std::cerr << "Warning: Gauss-Kronrod stopped at " << r.intervals << " intervals with estimated error "
+                      << r.error << " > " << tolerance << std::endl;
+        }
+        return r.value;
+    }
+
+private:
+    double tolerance;
+    int maxIntervals;
+    GaussKronrodRule rule;
+    int numThreads;
+};
+
+// Tanh-sinh quadrature: the substitution crowds nodes towards both ends
+// double exponentially, so endpoint singularities cost only a few levels
+class DoubleExponential : public Integration {
+public:
+    DoubleExponential(double a, double b, double tol)
+        : Integration(a, b, false, true), tolerance(tol) {}
+
+    double integrate(CachedFunction& func) override {
+        DoubleExponentialResult r = doubleExponential(std::cref(func), a, b, tolerance);
+        telemetry.errorEstimate = r.error;
+        telemetry.methodEvaluations = r.evaluations;
+        telemetry.maxDepthReached = r.levels;
+        telemetry.converged = r.converged;
+        if (!r.converged) {
+            std::cerr << "Warning: double exponential stopped at level " << r.levels << " with estimated error "
+                      << r.error << " > " << tolerance << std::endl;
+        }
+        return r.value;
+    }
+
+private:
+    double tolerance;
+};
+
+// Romberg: nested trapezoid levels (each evaluates only the new midpoints)
+// with Richardson extrapolation, doubling the interval count until converged
+class Romberg : public Integration {
+public:
+    Romberg(double a, double b, double tol, int maxLevels)
+        : Integration(a, b, false, true), tolerance(tol), maxLevels(maxLevels) {}
+
+    double integrate(CachedFunction& func) override {
+        RombergResult r = romberg(std::cref(func), a, b, tolerance, maxLevels);
+        telemetry.errorEstimate = r.error;
+        telemetry.methodEvaluations = r.evaluations;
+        telemetry.maxDepthReached = r.levels;
+        telemetry.converged = r.converged;
+        if (!r.converged) {
+            std::cerr << "Warning: Romberg stopped at " << (1LL << r.levels) << " intervals with estimated error "
+                      << r.error << " > " << tolerance << std::endl;
+        }
+        return r.value;
+    }
+
+private:
+    double tolerance;
+    int maxLevels;
+};
+
+// Composite Gauss-Legendre with 2 to 5 points per panel; the order is
+// picked at runtime, the rule itself is a compile-time instantiation
+class GaussLegendre : public Integration {
+public:
+    GaussLegendre(double a, double b, int order, int panels)
+        : Integration(a, b, false, false), order(order), panels(panels) {
+        if (order < 2 || order > 5)
+            throw std::invalid_argument("GaussLegendre order must be between 2 and 5");
+    }
+
+    double integrate(CachedFunction& func) override {
+        telemetry.methodEvaluations = order * panels;
+        switch (order) {
+        case 2: return compositeGauss<GaussLegendreRule<2>>(func, a, b, panels);
+        case 3: return compositeGauss<GaussLegendreRule<3>>(func, a, b, panels);
+        case 4: return compositeGauss<GaussLegendreRule<4>>(func, a, b, panels);
+        default: return compositeGauss<GaussLegendreRule<5>>(func, a, b, panels);
+        }
+    }
+
+private:
+    int order;
+    int panels;
+};
+
 // Overloading the `+` operator for cumulative integration results
 double operator+(Integration& lhs, Integration& rhs) {
     if (lhs.getB() != rhs.getA()) {
@@ -180,9 +342,9 @@ void benchmarkMethod(const MathFunction& analyticalFunction, Integration& integr
     std::cout << "Function evaluations: " << f.getEvaluationCount() << std::endl;
 }
 
-// Benchmark Integration Methods
+// Benchmark Integration Methods on a given cache type
 void benchmarkIntegrationMethods(std::vector<IntegrationResults>& results,
-                                 const MathFunction& f,
+                                 CachedFunction& cachedFunction,
                                  const std::string& methodName,
                                  const std::string& functionName,
                                  const std::string& cacheType,
@@ -190,8 +352,6 @@ void benchmarkIntegrationMethods(std::vector<IntegrationResults>& results,
                                  bool is_recursive,
                                  Integration& integrator,
                                  double analyticalResult) {
-    CachedFunction cachedFunction(f);
-
     auto start = std::chrono::high_resolution_clock::now();
     double numericalResult = integrator(cachedFunction);
     auto end = std::chrono::high_resolution_clock::now();
@@ -202,21 +362,49 @@ void benchmarkIntegrationMethods(std::vector<IntegrationResults>& results,
     IntegrationResults resultData(methodName, functionName, cacheType, intervals_or_depth,
                                   is_recursive, numericalResult, analyticalResult, absoluteError);
     resultData.execution_time = executionTime;
+    const IntegrationTelemetry& telemetry = integrator.getTelemetry();
+    resultData.function_evaluations = telemetry.evaluations;
+    resultData.error_estimate = telemetry.errorEstimate;
+    resultData.method_evaluations = telemetry.methodEvaluations;
+    resultData.cache_hit_rate = telemetry.cacheHitRate;
+    resultData.max_depth_reached = telemetry.maxDepthReached;
+    resultData.truncated_intervals = telemetry.truncatedIntervals;
+    resultData.converged = telemetry.converged;
+    resultData.evaluation_time = telemetry.evaluationTime;
 
     results.push_back(resultData);
 }
 
+void benchmarkIntegrationMethods(std::vector<IntegrationResults>& results,
+                                 const MathFunction& f,
+                                 const std::string& methodName,
+                                 const std::string& functionName,
+                                 const std::string& cacheType,
+                                 int intervals_or_depth,
+                                 bool is_recursive,
+                                 Integration& integrator,
+                                 double analyticalResult) {
+    CachedFunction cachedFunction(f);
+    benchmarkIntegrationMethods(results, cachedFunction, methodName, functionName, cacheType, intervals_or_depth,
+                                is_recursive, integrator, analyticalResult);
+}
+
 // Save results to CSV
 void saveResultsToCSV(const std::vector<IntegrationResults>& results, const std::string& filename) {
     std::ofstream file(filename);
     if (file.is_open()) {
         file << "method_name,function_name,cache_type,nb_intervals_or_max_depth,recursive,numerical_result,"
-                "analytical_result,absolute_error,execution_time\n";
+                "analytical_result,absolute_error,execution_time,function_evaluations,error_estimate,method_evaluations,"
+                "cache_hit_rate,max_depth_reached,truncated_intervals,converged,evaluation_time\n";
         for (const auto& result : results) {
             file << result.method_name << "," << result.function_name << "," << result.cache_type << ","
                  << result.nb_intervals_or_max_depth << "," << result.recursive << ","
                  << result.numerical_result << "," << result.analytical_result << ","
-                 << result.absolute_error << "," << result.execution_time << "\n";
+                 << result.absolute_error << "," << result.execution_time << ","
+                 << result.function_evaluations << "," << result.error_estimate << ","
+                 << result.method_evaluations << "," << result.cache_hit_rate << ","
+                 << result.max_depth_reached << "," << result.truncated_intervals << ","
+                 << result.converged << "," << result.evaluation_time << "\n";
         }
         file.close();
     }
@@ -247,8 +435,214 @@ void analyzeResults(const std::vector<IntegrationResults>& results) {
     std::cout << "Least accurate method: " << worstMethod << " with error = " << maxError << "\n";
 }
 
+// sqrt(x)(1-x)^2 for a whole batch of abscissae. Groups of four points go
+// through a branch-free loop that gcc vectorises at -O2; std::sqrt needs
+// -fno-math-errno for that, which the makefile passes.
+void sqrtWeightBatch(const double* x, double* fx, int n) {
+    const int lanes = 4;
+    int i = 0;
+    for (; i + lanes <= n; i += lanes) {
+        double v[lanes];
+        for (int j = 0; j < lanes; ++j) {
+            double y = 1 - x[i + j];
+            v[j] = std::sqrt(x[i + j]) * y * y;
+        }
+        for (int j = 0; j < lanes; ++j)
+            fx[i + j] = v[j];
+    }
+    for (; i < n; ++i) {
+        double y = 1 - x[i];
+        fx[i] = std::sqrt(x[i]) * y * y;
+    }
+}
+
+// Evaluations to reach 1e-12 on [0, 1] for integrands that are singular at
+// x = 0. The adaptive rules sample the endpoint, so there it is taken as
+// the limit (0 for the power laws; log(x) is cut off at 0 the same way).
+void compareSingularEndpoints() {
+    struct Case {
+        const char* name;
+        MathFunction f;
+        double exact;
+    };
+    const std::vector<Case> cases = {
+        {"sqrt(x)(1-x)^2", [](double x) { return std::sqrt(x) * (1 - x) * (1 - x); }, 16.0 / 105.0},
+        {"log(x)", [](double x) { return x > 0 ? std::log(x) : 0.0; }, -1.0},
+        {"pow(x, 0.75)", [](double x) { return std::pow(x, 0.75); }, 4.0 / 7.0},
+    };
+    const double tol = 1e-12;
+    const int maxDepth = 30;
+
+    std::cout << "\nEvaluations to tol " << tol << " on [0, 1] (max depth " << maxDepth << "):\n";
+    for (const Case& c : cases) {
+        int evals = 0;
+        MathFunction counted = [&](double x) { ++evals; return c.f(x); };
+
+        double trap = adaptiveTrapezoidalRecursive(counted, 0.0, 1.0, tol, maxDepth, 0);
+        int trapEvals = evals;
+        evals = 0;
+        double simpson = adaptiveSimpsonRecursive(counted, 0.0, 1.0, tol, maxDepth, 0);
+        int simpsonEvals = evals;
+        DoubleExponentialResult de = doubleExponential(c.f, 0.0, 1.0, tol);
+
+        std::cout << c.name
+                  << ": AdaptiveTrapezoidal " << trapEvals << " evals (error " << std::abs(trap - c.exact) << ")"
+                  << ", AdaptiveSimpson " << simpsonEvals << " evals (error " << std::abs(simpson - c.exact) << ")"
+                  << ", DoubleExponential " << de.evaluations << " evals (error " << std::abs(de.value - c.exact)
+                  << ", " << de.levels << " levels)\n";
+    }
+
+    // The same tanh-sinh rule with the integrand called once per point
+    // through MathFunction, and once per level through the batch
+    const int repetitions = 2000;
+    MathFunction scalarWeight = [](double x) { return std::sqrt(x) * (1 - x) * (1 - x); };
+    double scalarValue = 0.0, batchValue = 0.0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int r = 0; r < repetitions; ++r)
+        scalarValue += doubleExponential(scalarWeight, 0.0, 1.0, tol).value;
+    auto middle = std::chrono::high_resolution_clock::now();
+    for (int r = 0; r < repetitions; ++r)
+        batchValue += doubleExponentialBatch(sqrtWeightBatch, 0.0, 1.0, tol).value;
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::micro> scalarTime = middle - start;
+    std::chrono::duration<double, std::micro> batchTime = end - middle;
+    std::cout << "sqrt(x)(1-x)^2 DoubleExponential: scalar " << scalarTime.count() / repetitions
+              << " us (error " << std::abs(scalarValue / repetitions - cases[0].exact) << "), batch "
+              << batchTime.count() / repetitions << " us (error "
+              << std::abs(batchValue / repetitions - cases[0].exact) << ")\n";
+
+    // Reversed bounds give the negated integral
+    DoubleExponentialResult reversed = doubleExponential([](double x) { return std::sin(x); }, 2.0, 0.0, tol);
+    std::cout << "sin(x) DoubleExponential on [2, 0]: " << reversed.value << " (error "
+              << std::abs(reversed.value - (std::cos(2.0) - 1.0)) << ", converged " << reversed.converged << ")\n";
+}
+
+// The recursive rules as they were before they moved onto the engine:
+// every level evaluates f at its own endpoints (and midpoint) again
+double reevaluatingTrapezoidal(const MathFunction& f, double a, double b, double tol, int maxDepth, int depth) {
+    if (depth >= maxDepth)
+        return basicTrapezoidal(f, a, b);
+    double c = (a + b) / 2;
+    double one = basicTrapezoidal(f, a, b);
+    double two = basicTrapezoidal(f, a, c) + basicTrapezoidal(f, c, b);
+    if (std::abs(two - one) < tol)
+        return two;
+    return reevaluatingTrapezoidal(f, a, c, tol / 2, maxDepth, depth + 1) +
+           reevaluatingTrapezoidal(f, c, b, tol / 2, maxDepth, depth + 1);
+}
+
+double reevaluatingSimpson(const MathFunction& f, double a, double b, double tol, int maxDepth, int depth) {
+    if (depth >= maxDepth)
+        return basicSimpson(f, a, b);
+    double c = (a + b) / 2;
+    double whole = basicSimpson(f, a, b);
+    double two = basicSimpson(f, a, c) + basicSimpson(f, c, b);
+    if (std::abs(two - whole) < tol)
+        return two;
+    return reevaluatingSimpson(f, a, c, tol / 2, maxDepth, depth + 1) +
+           reevaluatingSimpson(f, c, b, tol / 2, maxDepth, depth + 1);
+}
+
+// Calls to f made by the original recursive functions, which re-evaluate
+// the endpoints and midpoint at every level, and by the engine, which
+// passes them down
+void compareValuePassing(double a, double b) {
+    std::cout << "\nCalls to f for sin(2x), tol 1e-10, max depth 25 (re-evaluating vs value-passing):\n";
+    int evals = 0;
+    MathFunction counted = [&evals](double x) { ++evals; return std::sin(2 * x); };
+    const double exact = integralSin2X(a, b);
+
+    double trap = reevaluatingTrapezoidal(counted, a, b, 1e-10, 25, 0);
+    int trapEvals = evals;
+    AdaptiveResult trapEngine = adaptiveIntegrate(testSin2X, a, b, 1e-10, 25, AdaptiveRule::Trapezoid,
+                                                  TolerancePolicy::HalvePerLevel);
+    evals = 0;
+    double simpson = reevaluatingSimpson(counted, a, b, 1e-10, 25, 0);
+    int simpsonEvals = evals;
+    AdaptiveResult simpsonEngine = adaptiveIntegrate(testSin2X, a, b, 1e-10, 25, AdaptiveRule::Simpson,
+                                                     TolerancePolicy::HalvePerLevel);
+
+    std::cout << "AdaptiveTrapezoidal: " << trapEvals << " vs " << trapEngine.evaluations << " (errors "
+              << std::abs(trap - exact) << ", " << std::abs(trapEngine.value - exact) << ")\n";
+    std::cout << "AdaptiveSimpson: " << simpsonEvals << " vs " << simpsonEngine.evaluations << " (errors "
+              << std::abs(simpson - exact) << ", " << std::abs(simpsonEngine.value - exact) << ")\n";
+}
+
+// Many small integrals, as in a parameter sweep: a fresh workspace per
+// call allocates every time, a reused one only on the first call
+void compareWorkspace(double a, double b) {
+    const int calls = 20000;
+    double freshSum = 0.0, reusedSum = 0.0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < calls; ++i) {
+        AdaptiveWorkspace fresh;
+        freshSum += adaptiveIntegrate(testSinX, a, b, 1e-6, 25, AdaptiveRule::Simpson, TolerancePolicy::HalvePerLevel,
+                                 fresh).value;
+    }
+    auto middle = std::chrono::high_resolution_clock::now();
+    AdaptiveWorkspace reused(25);
+    for (int i = 0; i < calls; ++i) {
+        reusedSum += adaptiveIntegrate(testSinX, a, b, 1e-6, 25, AdaptiveRule::Simpson, TolerancePolicy::HalvePerLevel,
+                                 reused).value;
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    std::cout << "\n" << calls << " adaptive Simpson integrals of sin(x): fresh workspace "
+              << std::chrono::duration<double>(middle - start).count() << " s, reused workspace ("
+              << reused.capacity() << " intervals) " << std::chrono::duration<double>(end - middle).count()
+              << " s, same results: " << (freshSum == reusedSum ? "yes" : "no") << "\n";
+}
+
+// Four threads integrate neighbouring quarters of [a, b] with adaptive
+// Simpson through one shared FastCachedFunction. Simpson evaluates every
+// interval's endpoints again in its children, and the quarters share their
+// boundaries, so most lookups hit.
+void compareSharedCache(double a, double b) {
+    FastCachedFunction shared(testSin2X);
+    const int parts = 4;
+    std::vector<double> partial(parts, 0.0);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < parts; ++i) {
+        threads.emplace_back([&, i]() {
+            double lo = a + (b - a) * i / parts;
+            double hi = a + (b - a) * (i + 1) / parts;
+            partial[i] = adaptiveSimpsonRecursive(std::cref(shared), lo, hi, 1e-10 / parts, 25, 0);
+        });
+    }
+    for (auto& t : threads)
+        t.join();
+
+    double total = 0.0;
+    for (double p : partial)
+        total += p;
+    CacheStats stats = shared.getCacheStats();
+    std::cout << "\nShared FastCachedFunction, " << parts << " threads on sin(2x): error "
+              << std::abs(total - integralSin2X(a, b)) << ", " << shared.getCount() << " evaluations, "
+              << stats.hits << " hits / " << stats.misses << " misses (hit rate " << stats.hitRate() << ")\n";
+}
+
+// Tolerance sweep through one cached function: the unbounded cache keeps
+// every distinct x, the bounded one stays at its fixed capacity
+void compareBoundedCache(double a, double b) {
+    FastCachedFunction unbounded(testSin2X);
+    BoundedCachedFunction bounded(testSin2X, 4096);
+    std::cout << "\nTolerance sweep on sin(2x), unbounded vs bounded (4096 entries) cache:\n";
+    for (double tol = 1e-4; tol > 1e-13; tol /= 100) {
+        adaptiveSimpsonRecursive(std::cref(unbounded), a, b, tol, 25, 0);
+        adaptiveSimpsonRecursive(std::cref(bounded), a, b, tol, 25, 0);
+        BoundedCacheStats s = bounded.getCacheStats();
+        std::cout << "tol " << tol << ": unbounded " << unbounded.getCacheSize() << " entries, bounded " << s.size
+                  << " entries (" << s.bytes << " bytes, " << s.evictions << " evictions, hit rate "
+                  << static_cast<double>(s.hits) / (s.hits + s.misses) << ")\n";
+    }
+}
+
 // Main function for benchmarking integration methods
 int main() {
+    // INTEGRATION_TRACE=<file> records every cached evaluation and hit there
+    if (const char* tracePath = std::getenv("INTEGRATION_TRACE"))
+        Tracer::instance().open(tracePath, TraceLevel::Debug);
+
     double a = 0.0;
     double b = M_PI;
 
@@ -271,6 +665,11 @@ int main() {
     Simpson simpsonIntegrator2(new_a, new_b, false, 20);
     AdaptiveTrapezoidal adaptiveTrapezoidalIntegrator3(new_a, new_b, true, 1e-5, 25);
     AdaptiveSimpson adaptiveSimpsonIntegrator4(new_a, new_b, true, 1e-5, 25);
+    GaussKronrod gaussKronrodIntegrator5(new_a, new_b, 1e-5, 2048, GaussKronrodRule::G7K15);
+    GaussKronrod gaussKronrodIntegrator6(new_a, new_b, 1e-5, 2048, GaussKronrodRule::G10K21);
+    DoubleExponential doubleExponentialIntegrator7(new_a, new_b, 1e-10);
+    Romberg rombergIntegrator8(new_a, new_b, 1e-10, 20);
+    GaussLegendre gaussLegendreIntegrator9(new_a, new_b, 5, 16);
 
     double analyticalResultSinX = integralSinX(new_a, new_b);
     double analyticalResultLogX = integralLogX(new_a, new_b);
@@ -292,9 +691,68 @@ int main() {
     benchmarkIntegrationMethods(results, testSin2X, "AdaptiveSimpson", "sin(2x)", "fast", 15, true, adaptiveSimpsonIntegrator4, analyticalResultSin2X);
     benchmarkIntegrationMethods(results, testSin2X, "AdaptiveSimpson", "sin(2x)", "slow", 25, true, adaptiveSimpsonIntegrator4, analyticalResultSin2X);
 
+    benchmarkIntegrationMethods(results, testSin2X, "GaussKronrod15", "sin(2x)", "none", 2048, false, gaussKronrodIntegrator5, analyticalResultSin2X);
+    benchmarkIntegrationMethods(results, testLogX, "GaussKronrod15", "log(x)", "none", 2048, false, gaussKronrodIntegrator5, analyticalResultLogX);
+    benchmarkIntegrationMethods(results, testSin2X, "GaussKronrod21", "sin(2x)", "none", 2048, false, gaussKronrodIntegrator6, analyticalResultSin2X);
+    benchmarkIntegrationMethods(results, testLogX, "GaussKronrod21", "log(x)", "none", 2048, false, gaussKronrodIntegrator6, analyticalResultLogX);
+
+    benchmarkIntegrationMethods(results, testSin2X, "DoubleExponential", "sin(2x)", "none", 0, false, doubleExponentialIntegrator7, analyticalResultSin2X);
+    benchmarkIntegrationMethods(results, testLogX, "DoubleExponential", "log(x)", "none", 0, false, doubleExponentialIntegrator7, analyticalResultLogX);
+
+    benchmarkIntegrationMethods(results, testSin2X, "Romberg", "sin(2x)", "none", 20, false, rombergIntegrator8, analyticalResultSin2X);
+    benchmarkIntegrationMethods(results, testLogX, "Romberg", "log(x)", "none", 20, false, rombergIntegrator8, analyticalResultLogX);
+
+    // Surrogate cache: f is fitted on [new_a, new_b] at the first call and
+    // every call is answered from the Chebyshev coefficients; the fit's
+    // evaluations are those of the row
+    SurrogateFunction surrogateSin2X(testSin2X, new_a, new_b);
+    SurrogateFunction surrogateLogX(testLogX, new_a, new_b);
+    benchmarkIntegrationMethods(results, surrogateSin2X, "AdaptiveSimpson", "sin(2x)", "surrogate", 25, true, adaptiveSimpsonIntegrator4, analyticalResultSin2X);
+    benchmarkIntegrationMethods(results, surrogateLogX, "GaussKronrod21", "log(x)", "surrogate", 2048, false, gaussKronrodIntegrator6, analyticalResultLogX);
+    std::cout << "\nSurrogates: sin(2x) " << surrogateSin2X.surrogate().pieces() << " pieces from "
+              << surrogateSin2X.getEvaluationCount() << " evaluations, log(x) " << surrogateLogX.surrogate().pieces()
+              << " pieces from " << surrogateLogX.getEvaluationCount() << " evaluations" << std::endl;
+
+    benchmarkIntegrationMethods(results, testSin2X, "GaussLegendre5", "sin(2x)", "none", 16, false, gaussLegendreIntegrator9, analyticalResultSin2X);
+    benchmarkIntegrationMethods(results, testLogX, "GaussLegendre5", "log(x)", "none", 16, false, gaussLegendreIntegrator9, analyticalResultLogX);
+
     saveResultsToCSV(results, "benchmark_results.csv");
 
     analyzeResults(results);
 
+    // Evaluations needed on a smooth integrand: local vs global adaptivity
+    std::cout << "\nEvaluations for sin(2x) on [" << new_a << ", " << new_b << "]:\n";
+    for (double tol : {1e-6, 1e-10}) {
+        int evals = 0;
+        MathFunction counted = [&evals](double x) { ++evals; return std::sin(2 * x); };
+        double simpson = adaptiveSimpsonRecursive(counted, new_a, new_b, tol, 25, 0);
+        int simpsonEvals = evals;
+        GaussKronrodResult gk = gaussKronrodAdaptive(testSin2X, new_a, new_b, tol, 2048, GaussKronrodRule::G7K15);
+        GaussKronrodResult gk21 = gaussKronrodAdaptive(testSin2X, new_a, new_b, tol, 2048, GaussKronrodRule::G10K21);
+        RombergResult rb = romberg(testSin2X, new_a, new_b, tol, 20);
+        std::cout << "tol " << tol
+                  << ": AdaptiveSimpson " << simpsonEvals << " evals (error " << std::abs(simpson - analyticalResultSin2X) << ")"
+                  << ", G7-K15 " << gk.evaluations << " evals (error " << std::abs(gk.value - analyticalResultSin2X)
+                  << ", estimate " << gk.error << ")"
+                  << ", G10-K21 " << gk21.evaluations << " evals (error " << std::abs(gk21.value - analyticalResultSin2X)
+                  << ", estimate " << gk21.error << ")"
+                  << ", Romberg " << rb.evaluations << " evals (error " << std::abs(rb.value - analyticalResultSin2X)
+                  << ", estimate " << rb.error << ")\n";
+    }
+
+    compareSingularEndpoints();
+
+    compareValuePassing(new_a, new_b);
+
+    compareWorkspace(new_a, new_b);
+
+    compareSharedCache(new_a, new_b);
+
+    compareBoundedCache(new_a, new_b);
+
+    Tracer::instance().close();
+    if (Tracer::instance().droppedEvents() > 0)
+        std::cout << "Trace: " << Tracer::instance().droppedEvents() << " events dropped (ring full)\n";
+
     return 0;
 }
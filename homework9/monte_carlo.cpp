@@ -0,0 +1,361 @@
+// monte_carlo.cpp
+// Monte Carlo and randomised quasi-Monte Carlo integration on boxes.
+#include "monte_carlo.h"
+#include "worker_team.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+namespace {
+
+// Sobol primitive polynomials and initial direction numbers (Joe and Kuo,
+// new-joe-kuo-6.21201) for dimensions 2 to 16; dimension 1 is van der Corput
+struct SobolPolynomial {
+    int s;
+    unsigned a;
+    unsigned m[6];
+};
+
+const SobolPolynomial sobolTable[] = {
+    {1, 0, {1}},
+    {2, 1, {1, 3}},
+    {3, 1, {1, 3, 1}},
+    {3, 2, {1, 1, 1}},
+    {4, 1, {1, 1, 3, 3}},
+    {4, 4, {1, 3, 5, 13}},
+    {5, 2, {1, 1, 5, 5, 17}},
+    {5, 4, {1, 1, 5, 5, 5}},
+    {5, 7, {1, 1, 7, 11, 19}},
+    {5, 11, {1, 1, 5, 1, 1}},
+    {5, 13, {1, 1, 1, 3, 11}},
+    {5, 14, {1, 3, 5, 5, 31}},
+    {6, 1, {1, 3, 3, 9, 7, 49}},
+    {6, 13, {1, 1, 1, 15, 21, 21}},
+    {6, 16, {1, 3, 1, 13, 27, 49}},
+};
+const int sobolDimensions = 1 + static_cast<int>(sizeof(sobolTable) / sizeof(sobolTable[0]));
+const int sobolBits = 32;
+
+// Direction numbers V[d][j], scaled to 32 bits
+struct SobolDirections {
+    std::uint32_t v[sobolDimensions][sobolBits];
+
+    SobolDirections() {
+        for (int j = 0; j < sobolBits; ++j)
+            v[0][j] = 1u << (31 - j);
+        for (int d = 1; d < sobolDimensions; ++d) {
+            const SobolPolynomial& p = sobolTable[d - 1];
+            for (int j = 0; j < sobolBits; ++j) {
+                if (j < p.s) {
+                    v[d][j] = p.m[j] << (31 - j);
+                } else {
+                    std::uint32_t x = v[d][j - p.s] ^ (v[d][j - p.s] >> p.s);
+                    for (int k = 1; k < p.s; ++k)
+                        if ((p.a >> (p.s - 1 - k)) & 1u)
+                            x ^= v[d][j - k];
+                    v[d][j] = x;
+                }
+            }
+        }
+    }
+};
+
+const SobolDirections& sobolDirections() {
+    static const SobolDirections directions;
+    return directions;
+}
+
+std::vector<int> firstPrimes(int n) {
+    std::vector<int> primes;
+    for (int c = 2; static_cast<int>(primes.size()) < n; ++c) {
+        bool prime = true;
+        for (int p : primes) {
+            if (p * p > c)
+                break;
+            if (c % p == 0) {
+                prime = false;
+                break;
+            }
+        }
+        if (prime)
+            primes.push_back(c);
+    }
+    return primes;
+}
+
+// Streams of the Philox counter space: word 3 of the counter tells samples
+// and scrambling draws apart, so they never overlap
+const std::uint32_t sampleStream = 0;
+const std::uint32_t scrambleStream = 1;
+
+Philox4x32::Key makeKey(std::uint64_t seed) {
+    return {static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32)};
+}
+
+// P(|T| <= t) for Student's t with dof degrees of freedom, from the finite
+// series of Abramowitz and Stegun 26.7.3 and 26.7.4
+double studentCoverage(double t, int dof) {
+    const double theta = std::atan(t / std::sqrt(static_cast<double>(dof)));
+    const double s = std::sin(theta), c2 = std::cos(theta) * std::cos(theta);
+    if (dof % 2 == 0) {
+        double term = 1.0, sum = 1.0;
+        for (int k = 2; k < dof; k += 2) {
+            term *= c2 * (k - 1) / k;
+            sum += term;
+        }
+        return s * sum;
+    }
+    double sum = 0.0;
+    if (dof > 1) {
+        double term = std::cos(theta);
+        sum = term;
+        for (int k = 3; k < dof; k += 2) {
+            term *= c2 * (k - 1) / k;
+            sum += term;
+        }
+    }
+    return 2 / M_PI * (theta + s * sum);
+}
+
+// Student-t quantile with the same two-sided coverage as the normal quantile z
+double studentQuantile(double z, int dof) {
+    const double coverage = std::erf(z / std::sqrt(2.0));
+    double lo = z, hi = z;
+    while (studentCoverage(hi, dof) < coverage)
+        hi *= 2;
+    for (int i = 0; i < 100; ++i) {
+        double mid = 0.5 * (lo + hi);
+        (studentCoverage(mid, dof) < coverage ? lo : hi) = mid;
+    }
+    return hi;
+}
+
+} // namespace
+
+Philox4x32::Counter Philox4x32::generate(Counter c, Key k) {
+    const std::uint64_t m0 = 0xD2511F53u, m1 = 0xCD9E8D57u;
+    const std::uint32_t w0 = 0x9E3779B9u, w1 = 0xBB67AE85u;
+    for (int round = 0; round < 10; ++round) {
+        std::uint64_t p0 = m0 * c[0];
+        std::uint64_t p1 = m1 * c[2];
+        c = {static_cast<std::uint32_t>(p1 >> 32) ^ c[1] ^ k[0], static_cast<std::uint32_t>(p1),
+             static_cast<std::uint32_t>(p0 >> 32) ^ c[3] ^ k[1], static_cast<std::uint32_t>(p0)};
+        k[0] += w0;
+        k[1] += w1;
+    }
+    return c;
+}
+
+void Philox4x32::uniforms(const Counter& counter, const Key& key, double& u0, double& u1) {
+    Counter r = generate(counter, key);
+    const double scale = 1.0 / 9007199254740992.0;  // 2^-53
+    u0 = static_cast<double>(((static_cast<std::uint64_t>(r[0]) << 32) | r[1]) >> 11) * scale;
+    u1 = static_cast<double>(((static_cast<std::uint64_t>(r[2]) << 32) | r[3]) >> 11) * scale;
+}
+
+void RunningStats::add(double x) {
+    ++n;
+    double delta = x - mean;
+    mean += delta / n;
+    m2 += delta * (x - mean);
+}
+
+void RunningStats::merge(const RunningStats& other) {
+    if (other.n == 0)
+        return;
+    if (n == 0) {
+        *this = other;
+        return;
+    }
+    long long total = n + other.n;
+    double delta = other.mean - mean;
+    mean += delta * other.n / total;
+    m2 += other.m2 + delta * delta * (static_cast<double>(n) * other.n / total);
+    n = total;
+}
+
+int sobolMaxDimension() {
+    return sobolDimensions;
+}
+
+// Gray-code order computed directly from the index, so any block of the
+// sequence can be generated on its own
+void sobolPoint(std::uint64_t i, int dim, const std::vector<std::uint32_t>& shift, double* x) {
+    const SobolDirections& dir = sobolDirections();
+    std::uint64_t gray = i ^ (i >> 1);
+    for (int d = 0; d < dim; ++d) {
+        std::uint32_t bits = shift.empty() ? 0u : shift[d];
+        for (int j = 0; j < sobolBits && (gray >> j) != 0; ++j)
+            if ((gray >> j) & 1u)
+                bits ^= dir.v[d][j];
+        x[d] = bits * (1.0 / 4294967296.0);
+    }
+}
+
+// Radical inverse in the d-th prime base; digits pass through a per-axis
+// permutation that keeps 0 fixed, so trailing zeros stay zeros. The point is
+// then rotated by shift[d] modulo 1, which makes it uniform on [0, 1)^dim:
+// the permutation alone never touches the trailing zeros and leaves the
+// estimator biased.
+void haltonPoint(std::uint64_t i, int dim, const std::vector<std::vector<int>>& permutations,
+                 const std::vector<double>& shift, double* x) {
+    static const std::vector<int> primes = firstPrimes(256);
+    if (dim > static_cast<int>(primes.size()))
+        throw std::invalid_argument("Halton sequence supports at most 256 dimensions");
+    for (int d = 0; d < dim; ++d) {
+        const std::uint64_t base = primes[d];
+        const double inverseBase = 1.0 / base;
+        double factor = inverseBase;
+        double value = 0.0;
+        for (std::uint64_t n = i + 1; n > 0; n /= base) {  // Skip the all-zero point
+            int digit = static_cast<int>(n % base);
+            value += (permutations.empty() ? digit : permutations[d][digit]) * factor;
+            factor *= inverseBase;
+        }
+        if (!shift.empty()) {
+            value += shift[d];
+            if (value >= 1.0)
+                value -= 1.0;
+        }
+        x[d] = value;
+    }
+}
+
+// Work is split into fixed blocks of sample indices. A round evaluates a
+// fixed number of blocks for every replicate in parallel, then merges the
+// block statistics in block order and checks the confidence interval, so
+// both the estimate and the stopping point are independent of numThreads.
+// Monte Carlo uses the sample variance; Sobol/Halton use the spread of the
+// replicate means, each replicate with its own random scrambling, and a
+// Student-t quantile for the few replicates.
+MonteCarloResult monteCarloIntegrate(const PointBatchFunction& f, int dim, const std::vector<double>& lower,
+                                     const std::vector<double>& upper, const MonteCarloOptions& options) {
+    if (dim < 1 || static_cast<int>(lower.size()) != dim || static_cast<int>(upper.size()) != dim)
+        throw std::invalid_argument("Box bounds must have one entry per dimension");
+    if (options.method == SamplingMethod::Sobol && dim > sobolMaxDimension())
+        throw std::invalid_argument("Sobol sequence supports at most " + std::to_string(sobolMaxDimension()) +
+                                    " dimensions");
+    if (options.blockSize < 1 || options.blocksPerRound < 1)
+        throw std::invalid_argument("blockSize and blocksPerRound must be positive");
+
+    double volume = 1.0;
+    for (int d = 0; d < dim; ++d)
+        volume *= upper[d] - lower[d];
+
+    const Philox4x32::Key key = makeKey(options.seed);
+    const bool qmc = options.method != SamplingMethod::MonteCarlo;
+    const int replicates = qmc && options.scramble ? std::max(2, options.replicates) : 1;
+
+    // Scrambling draws for every replicate
+    std::vector<std::vector<std::uint32_t>> shifts(replicates);
+    std::vector<std::vector<double>> rotations(replicates);
+    std::vector<std::vector<std::vector<int>>> permutations(replicates);
+    if (qmc && options.scramble) {
+        static const std::vector<int> primes = firstPrimes(256);
+        for (int r = 0; r < replicates; ++r) {
+            for (int d = 0; d < dim; ++d) {
+                Philox4x32::Counter r4 = Philox4x32::generate(
+                    {static_cast<std::uint32_t>(r), static_cast<std::uint32_t>(d), 0, scrambleStream}, key);
+                shifts[r].push_back(r4[0]);
+                const double scale = 1.0 / 9007199254740992.0;  // 2^-53
+                rotations[r].push_back(
+                    static_cast<double>(((static_cast<std::uint64_t>(r4[2]) << 32) | r4[3]) >> 11) * scale);
+                if (options.method == SamplingMethod::Halton && d < static_cast<int>(primes.size())) {
+                    std::vector<int> perm(primes[d]);
+                    for (int k = 0; k < primes[d]; ++k)
+                        perm[k] = k;
+                    // Fisher-Yates on digits 1..b-1
+                    for (int k = primes[d] - 1; k > 1; --k) {
+                        Philox4x32::Counter c = Philox4x32::generate(
+                            {static_cast<std::uint32_t>(r), static_cast<std::uint32_t>(d),
+                             static_cast<std::uint32_t>(k), scrambleStream}, key);
+                        std::swap(perm[k], perm[1 + c[0] % k]);
+                    }
+                    permutations[r].push_back(perm);
+                }
+            }
+        }
+    }
+
+    // Fills points for sample indices [begin, end) of replicate r
+    auto samplePoints = [&](int r, long long begin, long long end, std::vector<double>& points) {
+        int n = static_cast<int>(end - begin);
+        points.resize(static_cast<size_t>(n) * dim);
+        for (int s = 0; s < n; ++s) {
+            std::uint64_t index = static_cast<std::uint64_t>(begin + s);
+            double* x = &points[static_cast<size_t>(s) * dim];
+            if (options.method == SamplingMethod::Sobol) {
+                sobolPoint(index, dim, shifts[r], x);
+            } else if (options.method == SamplingMethod::Halton) {
+                haltonPoint(index, dim, permutations[r], rotations[r], x);
+            } else {
+                for (int d = 0; d < dim; d += 2) {
+                    double u0, u1;
+                    Philox4x32::uniforms({static_cast<std::uint32_t>(index), static_cast<std::uint32_t>(index >> 32),
+                                          static_cast<std::uint32_t>(d / 2), sampleStream}, key, u0, u1);
+                    x[d] = u0;
+                    if (d + 1 < dim)
+                        x[d + 1] = u1;
+                }
+            }
+            for (int d = 0; d < dim; ++d)
+                x[d] = lower[d] + (upper[d] - lower[d]) * x[d];
+        }
+    };
+
+    // Half-width factor: the replicate spread has only replicates - 1 degrees of freedom
+    const double quantile = replicates > 1 ? studentQuantile(options.z, replicates - 1) : options.z;
+
+    std::vector<RunningStats> totals(replicates);
+    // One team serves every round
+    const long long maxJobs = static_cast<long long>(options.blocksPerRound) * replicates;
+    WorkerTeam team(static_cast<int>(std::max(1LL, std::min<long long>(options.numThreads, maxJobs))));
+    long long done = 0;
+    double value = 0.0, standardError = 0.0;
+    bool converged = false;
+    while (done < options.maxSamples && !converged) {
+        long long roundEnd = std::min(options.maxSamples, done + options.blocksPerRound * options.blockSize);
+        long long blocks = (roundEnd - done + options.blockSize - 1) / options.blockSize;
+        long long jobs = blocks * replicates;
+        std::vector<RunningStats> partial(static_cast<size_t>(jobs));
+
+        team.run([&](int t) {
+            std::vector<double> points, values;
+            for (long long job = t; job < jobs; job += team.size()) {
+                int r = static_cast<int>(job / blocks);
+                long long begin = done + (job % blocks) * options.blockSize;
+                long long end = std::min(roundEnd, begin + options.blockSize);
+                samplePoints(r, begin, end, points);
+                values.resize(static_cast<size_t>(end - begin));
+                f(points.data(), values.data(), static_cast<int>(values.size()));
+                for (double v : values)
+                    partial[job].add(volume * v);
+            }
+        });
+
+        for (long long job = 0; job < jobs; ++job)
+            totals[job / blocks].merge(partial[job]);
+        done = roundEnd;
+
+        if (replicates == 1) {
+            value = totals[0].mean;
+            standardError = qmc ? 0.0 : std::sqrt(totals[0].variance() / totals[0].n);
+        } else {
+            RunningStats means;
+            for (const RunningStats& t : totals)
+                means.add(t.mean);
+            value = means.mean;
+            standardError = std::sqrt(means.variance() / replicates);
+        }
+        // Unscrambled QMC has no error estimate and runs to maxSamples
+        bool hasEstimate = !qmc || replicates > 1;
+        converged = hasEstimate && options.tolerance > 0 && quantile * standardError <= options.tolerance;
+    }
+
+    return MonteCarloResult{value, standardError, quantile * standardError, done * replicates, converged};
+}
@@ -0,0 +1,71 @@
+#ifndef MONTE_CARLO_H
+#define MONTE_CARLO_H
+
+#include <array>
+#include <cstdint>
+#include <vector>
+#include "cubature.h"
+
+// Philox4x32-10 counter-based generator: the output is a pure function of
+// (counter, key), so sample i of a run is the same no matter which thread
+// draws it or in which order.
+struct Philox4x32 {
+    using Counter = std::array<std::uint32_t, 4>;
+    using Key = std::array<std::uint32_t, 2>;
+
+    static Counter generate(Counter counter, Key key);
+
+    // Two uniform doubles in [0, 1) with 53 random bits each
+    static void uniforms(const Counter& counter, const Key& key, double& u0, double& u1);
+};
+
+// Streaming mean and variance (Welford); merge() combines two partial runs
+// (Chan et al.), so block statistics can be reduced in a fixed order
+struct RunningStats {
+    long long n = 0;
+    double mean = 0.0;
+    double m2 = 0.0;
+
+    void add(double x);
+    void merge(const RunningStats& other);
+    double variance() const { return n > 1 ? m2 / (n - 1) : 0.0; }
+};
+
+enum class SamplingMethod { MonteCarlo, Sobol, Halton };
+
+struct MonteCarloOptions {
+    SamplingMethod method = SamplingMethod::MonteCarlo;
+    std::uint64_t seed = 0x5305;
+    bool scramble = true;            // Digital shift (Sobol) or digit permutation and shift mod 1 (Halton)
+    long long maxSamples = 1 << 22;  // Per replicate for Sobol/Halton
+    long long blockSize = 4096;      // Fixed work unit; results depend on it, not on numThreads
+    int blocksPerRound = 16;         // Blocks between two convergence checks
+    double tolerance = 0.0;          // Stop when the confidence half-width is below this (0 = never)
+    double z = 1.96;                 // Normal quantile of the confidence level; replicated
+                                     // Sobol/Halton use the Student-t quantile of the same level
+    int replicates = 8;              // Independent scramblings for the Sobol/Halton error estimate
+    int numThreads = 1;
+};
+
+struct MonteCarloResult {
+    double value;           // Integral estimate
+    double standardError;   // Estimated standard error of value
+    double halfWidth;       // Quantile (z, or Student-t for replicates) * standardError
+    long long samples;      // Integrand evaluations
+    bool converged;         // Whether halfWidth <= tolerance was reached
+};
+
+// Largest dimension the built-in Sobol direction numbers support
+int sobolMaxDimension();
+
+// Point i of the (optionally scrambled) Sobol or Halton sequence in [0, 1)^dim
+void sobolPoint(std::uint64_t i, int dim, const std::vector<std::uint32_t>& shift, double* x);
+void haltonPoint(std::uint64_t i, int dim, const std::vector<std::vector<int>>& permutations,
+                 const std::vector<double>& shift, double* x);
+
+// Integral of f over the box [lower, upper] by Monte Carlo or randomised
+// quasi-Monte Carlo. Results are bitwise reproducible for any numThreads.
+MonteCarloResult monteCarloIntegrate(const PointBatchFunction& f, int dim, const std::vector<double>& lower,
+                                     const std::vector<double>& upper, const MonteCarloOptions& options = {});
+
+#endif // MONTE_CARLO_H
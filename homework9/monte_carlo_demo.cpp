@@ -0,0 +1,69 @@
+// monte_carlo_demo.cpp
+// Monte Carlo vs scrambled Sobol/Halton on the Sobol g-function, with
+// early stopping and a thread-count reproducibility check.
+#include "monte_carlo.h"
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+// Sobol g-function: prod (|4x - 2| + a_i) / (1 + a_i), integral 1 over [0, 1]^d
+PointBatchFunction gFunction(int dim) {
+    return [dim](const double* p, double* v, int n) {
+        for (int i = 0; i < n; ++i) {
+            double prod = 1.0;
+            for (int d = 0; d < dim; ++d) {
+                double a = 0.5 * d;
+                prod *= (std::abs(4 * p[i * dim + d] - 2) + a) / (1 + a);
+            }
+            v[i] = prod;
+        }
+    };
+}
+
+const char* methodName(SamplingMethod method) {
+    switch (method) {
+    case SamplingMethod::Sobol: return "Sobol";
+    case SamplingMethod::Halton: return "Halton";
+    default: return "MonteCarlo";
+    }
+}
+
+int main() {
+    std::cout.precision(10);
+
+    for (int dim : {6, 16}) {
+        std::vector<double> lower(dim, 0.0), upper(dim, 1.0);
+        std::cout << "g-function, d = " << dim << ", tolerance 1e-3 (95% half-width):\n";
+        for (SamplingMethod method : {SamplingMethod::MonteCarlo, SamplingMethod::Sobol, SamplingMethod::Halton}) {
+            MonteCarloOptions options;
+            options.method = method;
+            options.tolerance = 1e-3;
+            options.maxSamples = 1 << 22;
+
+            auto start = std::chrono::high_resolution_clock::now();
+            MonteCarloResult r = monteCarloIntegrate(gFunction(dim), dim, lower, upper, options);
+            auto end = std::chrono::high_resolution_clock::now();
+
+            std::cout << "  " << methodName(method) << ": " << r.value << " (error " << std::abs(r.value - 1.0)
+                      << ", half-width " << r.halfWidth << ") with " << r.samples << " samples"
+                      << (r.converged ? "" : ", not converged") << " in "
+                      << std::chrono::duration<double, std::milli>(end - start).count() << " ms\n";
+        }
+    }
+
+    // Same seed, different thread counts: the estimate must not change
+    const int dim = 8;
+    std::vector<double> lower(dim, 0.0), upper(dim, 1.0);
+    MonteCarloOptions options;
+    options.maxSamples = 1 << 18;
+    options.numThreads = 1;
+    MonteCarloResult one = monteCarloIntegrate(gFunction(dim), dim, lower, upper, options);
+    options.numThreads = 7;
+    MonteCarloResult seven = monteCarloIntegrate(gFunction(dim), dim, lower, upper, options);
+    std::cout << "\nReproducible across 1 and 7 threads: "
+              << (std::memcmp(&one.value, &seven.value, sizeof(double)) == 0 ? "yes" : "no") << " (" << one.value
+              << ")\n";
+
+    return 0;
+}
@@ -0,0 +1,316 @@
+// oscillatory.cpp
+// Quadrature for highly oscillatory integrands: Filon-Clenshaw-Curtis for
+// g(x) * sin/cos(omega x), given directly or recognised from evenly spaced
+// zeros, and a sign-change partition for other oscillatory functions.
+#include "integration_methods.h"
+#include "static_integration.h"
+#include <algorithm>
+#include <cmath>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+namespace {
+
+const int filonDegree = 16;
+
+// Moments of the oscillator on [-1, 1]: cosMoments[k] + i sinMoments[k] is
+// the integral of T_k(t) e^(i sigma t). Composite 5-point Gauss with at most
+// half a radian of phase (oscillator plus T_k) per subpanel.
+void oscillatorMoments(double sigma, int degree, std::vector<double>& cosMoments, std::vector<double>& sinMoments) {
+    typedef GaussLegendreRule<5> Rule;
+    int subpanels = std::max(4, static_cast<int>(std::ceil(4 * (std::abs(sigma) + degree))));
+    double h = 2.0 / subpanels;
+    cosMoments.assign(degree + 1, 0.0);
+    sinMoments.assign(degree + 1, 0.0);
+    for (int s = 0; s < subpanels; ++s) {
+        double mid = -1 + (s + 0.5) * h;
+        for (int i = 0; i < Rule::points; ++i) {
+            double t = mid + 0.5 * h * Rule::node(i);
+            double w = 0.5 * h * Rule::weight(i);
+            double c = w * std::cos(sigma * t), sn = w * std::sin(sigma * t);
+            double previous = 1.0, current = t;  // T_0, T_1
+            cosMoments[0] += c;
+            sinMoments[0] += sn;
+            for (int k = 1; k <= degree; ++k) {
+                cosMoments[k] += current * c;
+                sinMoments[k] += current * sn;
+                double next = 2 * t * current - previous;
+                previous = current;
+                current = next;
+            }
+        }
+    }
+}
+
+// Chebyshev coefficients of g on [lo, hi] from its values at the degree + 1
+// extreme points; cosines[j * (degree + 1) + k] = cos(pi j k / degree)
+void chebyshevCoefficients(const MathFunction& g, double lo, double hi, int degree,
+                           const std::vector<double>& cosines, std::vector<double>& coefficients) {
+    const int n = degree + 1;
+    double mid = (lo + hi) / 2, half = (hi - lo) / 2;
+    std::vector<double> samples(n);
+    for (int j = 0; j < n; ++j)
+        samples[j] = g(mid + half * cosines[j * n + 1]);
+    coefficients.assign(n, 0.0);
+    for (int k = 0; k < n; ++k) {
+        double sum = 0.5 * (samples[0] + samples[degree] * cosines[degree * n + k]);
+        for (int j = 1; j < degree; ++j)
+            sum += samples[j] * cosines[j * n + k];
+        coefficients[k] = 2 * sum / degree / ((k == 0 || k == degree) ? 2 : 1);
+    }
+}
+
+// One Filon estimate of the integral of g(x) * sin(omega x + phase) on
+// panels equal panels
+double filonSum(const MathFunction& g, double omega, double phase, double a, double b, int panels,
+                const std::vector<double>& cosines) {
+    double width = (b - a) / panels;
+    double half = width / 2;
+    std::vector<double> cosMoments, sinMoments, c;
+    oscillatorMoments(omega * half, filonDegree, cosMoments, sinMoments);
+
+    double sum = 0.0;
+    for (int p = 0; p < panels; ++p) {
+        double lo = a + p * width, hi = (p + 1 == panels) ? b : lo + width;
+        chebyshevCoefficients(g, lo, hi, filonDegree, cosines, c);
+        double re = 0.0, im = 0.0;
+        for (int k = 0; k <= filonDegree; ++k) {
+            re += c[k] * cosMoments[k];
+            im += c[k] * sinMoments[k];
+        }
+        // e^(i (omega x + phase)) = e^(i (omega mid + phase)) e^(i omega half t)
+        double mid = (lo + hi) / 2;
+        double angle = omega * mid + phase;
+        sum += half * (std::sin(angle) * re + std::cos(angle) * im);
+    }
+    return sum;
+}
+
+// Filon with panel doubling until two estimates agree to within tol
+OscillatoryResult filonPhase(const MathFunction& g, double omega, double phase, double a, double b, double tol,
+                             int maxPanels) {
+    const int n = filonDegree + 1;
+    std::vector<double> cosines(n * n);
+    for (int j = 0; j < n; ++j)
+        for (int k = 0; k < n; ++k)
+            cosines[j * n + k] = std::cos(M_PI * ((j * k) % (2 * filonDegree)) / filonDegree);
+
+    double previous = filonSum(g, omega, phase, a, b, 1, cosines);
+    OscillatoryResult result{previous, 0.0, n, 1, false, OscillatoryMethod::Filon};
+    for (int panels = 2; panels <= maxPanels; panels *= 2) {
+        double current = filonSum(g, omega, phase, a, b, panels, cosines);
+        result.evaluations += panels * n;
+        result.value = current;
+        result.panels = panels;
+        result.error = std::abs(current - previous);
+        if (result.error <= tol) {
+            result.converged = true;
+            break;
+        }
+        previous = current;
+    }
+    return result;
+}
+
+// A sign change of f between two grid samples
+struct Bracket {
+    double lo, hi, flo, fhi;
+};
+
+std::vector<Bracket> signChangeBrackets(const OscillationEstimate& estimate) {
+    std::vector<Bracket> brackets;
+    double lastX = 0.0, lastF = 0.0;
+    for (size_t i = 0; i < estimate.x.size(); ++i) {
+        double x = estimate.x[i], v = estimate.fx[i];
+        if (v == 0.0)
+            continue;
+        if (lastF != 0.0 && (v > 0) != (lastF > 0))
+            brackets.push_back(Bracket{lastX, x, lastF, v});
+        lastX = x;
+        lastF = v;
+    }
+    return brackets;
+}
+
+// Zero of f inside a bracket by the Illinois variant of regula falsi
+double refineZero(const MathFunction& f, Bracket br, double scale, int& evaluations) {
+    int side = 0;
+    for (int i = 0; i < 60 && br.hi - br.lo > 4e-16 * scale; ++i) {
+        double x = br.hi - br.fhi * (br.hi - br.lo) / (br.fhi - br.flo);
+        if (!(x > br.lo && x < br.hi))
+            x = (br.lo + br.hi) / 2;
+        double fx = f(x);
+        ++evaluations;
+        if (fx == 0.0)
+            return x;
+        if ((fx > 0) == (br.fhi > 0)) {
+            br.hi = x;
+            br.fhi = fx;
+            if (side == -1)
+                br.flo /= 2;
+            side = -1;
+        } else {
+            br.lo = x;
+            br.flo = fx;
+            if (side == 1)
+                br.fhi /= 2;
+            side = 1;
+        }
+    }
+    return br.hi - br.fhi * (br.hi - br.lo) / (br.fhi - br.flo);
+}
+
+// Linear phase test: zeros z_k = z_0 + k pi / omega. Five zeros spread over
+// the brackets are refined and must fit the line to 1e-9 of a spacing, the
+// interpolated position of every other zero to 5% of a spacing.
+bool fitLinearPhase(const MathFunction& f, const std::vector<Bracket>& brackets, double a, double b,
+                    double& omega, double& phase, int& evaluations) {
+    const int zeros = static_cast<int>(brackets.size());
+    const double scale = std::max(std::max(std::abs(a), std::abs(b)), b - a);
+    const int picks[] = {0, zeros / 4, zeros / 2, 3 * zeros / 4, zeros - 1};
+    double refined[5];
+    for (int i = 0; i < 5; ++i)
+        refined[i] = refineZero(f, brackets[picks[i]], scale, evaluations);
+    double spacing = (refined[4] - refined[0]) / (zeros - 1);
+    if (!(spacing > 0))
+        return false;
+    for (int i = 1; i < 4; ++i)
+        if (std::abs(refined[i] - (refined[0] + picks[i] * spacing)) > 1e-9 * spacing)
+            return false;
+    for (int k = 0; k < zeros; ++k) {
+        const Bracket& br = brackets[k];
+        double z = br.lo - br.flo * (br.hi - br.lo) / (br.fhi - br.flo);
+        if (std::abs(z - (refined[0] + k * spacing)) > 0.05 * spacing)
+            return false;
+    }
+    omega = M_PI / spacing;
+    phase = std::fmod(-omega * refined[0], 2 * M_PI);
+    return true;
+}
+
+}  // namespace
+
+OscillatoryResult filonIntegrate(const MathFunction& g, double omega, OscillatorKind kind, double a, double b,
+                                 double tol, int maxPanels) {
+    // cos(omega x) = sin(omega x + pi / 2)
+    return filonPhase(g, omega, kind == OscillatorKind::Cos ? M_PI / 2 : 0.0, a, b, tol, maxPanels);
+}
+
+OscillationEstimate detectOscillation(const MathFunction& f, double a, double b, int minSignChanges,
+                                      int maxSamples) {
+    OscillationEstimate estimate;
+    int intervals = 1024;
+    estimate.x.resize(intervals + 1);
+    estimate.fx.resize(intervals + 1);
+    for (int i = 0; i <= intervals; ++i) {
+        estimate.x[i] = a + (b - a) * i / intervals;
+        estimate.fx[i] = f(estimate.x[i]);
+    }
+
+    auto countSignChanges = [&]() {
+        int changes = 0;
+        double last = 0.0;
+        for (double v : estimate.fx) {
+            if (v == 0.0)
+                continue;
+            if (last != 0.0 && (v > 0) != (last > 0))
+                ++changes;
+            last = v;
+        }
+        return changes;
+    };
+
+    // Fewer than 8 samples per sign change could hide faster oscillation,
+    // so refine; the old samples become the even points of the new grid
+    estimate.signChanges = countSignChanges();
+    while (8LL * estimate.signChanges > intervals && 2 * intervals <= maxSamples) {
+        std::vector<double> x(2 * intervals + 1), fx(2 * intervals + 1);
+        for (int i = 0; i <= intervals; ++i) {
+            x[2 * i] = estimate.x[i];
+            fx[2 * i] = estimate.fx[i];
+        }
+        intervals *= 2;
+        for (int i = 1; i < intervals; i += 2) {
+            x[i] = a + (b - a) * i / intervals;
+            fx[i] = f(x[i]);
+        }
+        estimate.x.swap(x);
+        estimate.fx.swap(fx);
+        estimate.signChanges = countSignChanges();
+    }
+    estimate.oscillatory = estimate.signChanges >= minSignChanges;
+    return estimate;
+}
+
+OscillatoryResult integrateOscillatory(const MathFunction& f, double a, double b, double tol) {
+    OscillationEstimate estimate = detectOscillation(f, a, b);
+    OscillatoryResult result{0.0, 0.0, static_cast<int>(estimate.x.size()), 0, true,
+                             OscillatoryMethod::ZeroCrossings};
+
+    if (!estimate.oscillatory) {
+        GaussKronrodResult r = gaussKronrodAdaptive(f, a, b, tol, 2048, GaussKronrodRule::G10K21);
+        result.value = r.value;
+        result.error = r.error;
+        result.evaluations += r.evaluations;
+        result.panels = r.intervals;
+        result.converged = r.converged;
+        result.method = OscillatoryMethod::GaussKronrod;
+        return result;
+    }
+
+    std::vector<Bracket> brackets = signChangeBrackets(estimate);
+
+    // Evenly spaced zeros: recover g and integrate it with Filon
+    double omega, phase;
+    if (fitLinearPhase(f, brackets, a, b, omega, phase, result.evaluations)) {
+        int calls = 0;
+        auto ratio = [&](double x) {
+            ++calls;
+            return f(x) / std::sin(omega * x + phase);
+        };
+        // Within 1e-3 rad of a zero of the oscillator the quotient loses
+        // accuracy; average g at 1e-3 rad on either side instead (one-sided
+        // linear extrapolation at the ends of [a, b])
+        const double delta = 1e-3 / omega;
+        MathFunction g = [&](double x) {
+            if (std::abs(std::sin(omega * x + phase)) >= 1e-3)
+                return ratio(x);
+            if (x - delta >= a && x + delta <= b)
+                return (ratio(x - delta) + ratio(x + delta)) / 2;
+            double step = (x + 2 * delta <= b) ? delta : -delta;
+            return 2 * ratio(x + step) - ratio(x + 2 * step);
+        };
+        OscillatoryResult filon = filonPhase(g, omega, phase, a, b, tol, 64);
+        result.evaluations += calls;
+        if (filon.converged) {
+            result.value = filon.value;
+            result.error = filon.error;
+            result.panels = filon.panels;
+            result.method = OscillatoryMethod::Filon;
+            return result;
+        }
+    }
+
+    // Panel boundaries at every second sign change (one period per panel),
+    // placed at the linearly interpolated zero
+    std::vector<double> boundaries(1, a);
+    for (size_t k = 1; k < brackets.size(); k += 2) {
+        const Bracket& br = brackets[k];
+        boundaries.push_back(br.lo - br.flo * (br.hi - br.lo) / (br.fhi - br.flo));
+    }
+    boundaries.push_back(b);
+
+    for (size_t p = 0; p + 1 < boundaries.size(); ++p) {
+        double lo = boundaries[p], hi = boundaries[p + 1];
+        GaussKronrodResult r =
+            gaussKronrodAdaptive(f, lo, hi, tol * (hi - lo) / (b - a), 64, GaussKronrodRule::G10K21);
+        result.value += r.value;
+        result.error += r.error;
+        result.evaluations += r.evaluations;
+        result.panels += 1;
+        result.converged = result.converged && r.converged;
+    }
+    return result;
+}
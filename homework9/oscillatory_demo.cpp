@@ -0,0 +1,61 @@
+// oscillatory_demo.cpp
+// Evaluations and time to reach 1e-8 on the oscillatory test integrands:
+// adaptive Simpson, the automatic oscillatory routing, and for f1 (whose
+// phase is linear) Filon quadrature of exp(-x^2) * sin(1000 x).
+#include "complicated_functions.h"
+#include "integration_methods.h"
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+namespace {
+
+void report(const char* name, long long evaluations, double seconds, double value, double reference, bool converged) {
+    std::cout << "  " << name << ": " << evaluations << " evaluations, " << seconds << " s, error "
+              << std::abs(value - reference) << (converged ? "" : " (not converged)") << "\n";
+}
+
+double since(std::chrono::high_resolution_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+}  // namespace
+
+int main() {
+    struct Case {
+        const char* name;
+        double (*f)(double);
+    };
+    const Case cases[] = {{"f1", f1}, {"f5", f5}};
+    const double a = 0.0, b = 1.0, tol = 1e-8;
+
+    std::cout.precision(6);
+    for (const Case& c : cases) {
+        double reference = gaussKronrodAdaptive(c.f, a, b, 1e-13, 100000, GaussKronrodRule::G10K21).value;
+        std::cout << c.name << " on [" << a << ", " << b << "], tol " << tol << ":\n";
+
+        auto start = std::chrono::high_resolution_clock::now();
+        AdaptiveResult simpson = adaptiveIntegrate(c.f, a, b, tol, 20, AdaptiveRule::Simpson,
+                                                   TolerancePolicy::HalvePerLevel);
+        double seconds = since(start);
+        report("adaptive Simpson", simpson.evaluations, seconds, simpson.value, reference,
+               simpson.truncatedIntervals == 0);
+
+        start = std::chrono::high_resolution_clock::now();
+        OscillatoryResult automatic = integrateOscillatory(c.f, a, b, tol);
+        seconds = since(start);
+        const char* route = automatic.method == OscillatoryMethod::Filon           ? "automatic (Filon)"
+                            : automatic.method == OscillatoryMethod::ZeroCrossings ? "automatic (sign-change panels)"
+                                                                                   : "automatic (Gauss-Kronrod)";
+        report(route, automatic.evaluations, seconds, automatic.value, reference, automatic.converged);
+
+        if (c.f == f1) {
+            start = std::chrono::high_resolution_clock::now();
+            OscillatoryResult filon = filonIntegrate([](double x) { return std::exp(-x * x); }, 1000.0,
+                                                     OscillatorKind::Sin, a, b, tol);
+            seconds = since(start);
+            report("Filon", filon.evaluations, seconds, filon.value, reference, filon.converged);
+        }
+    }
+    return 0;
+}
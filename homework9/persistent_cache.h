@@ -0,0 +1,238 @@
+#ifndef PERSISTENT_CACHE_H
+#define PERSISTENT_CACHE_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "definitions.h"
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "PersistentCache needs address-free 64-bit atomics");
+
+// On-disk evaluation cache shared by every process that maps the same file.
+//
+// The file holds a header, an append-only array of records (function id,
+// exact x bits, value) and a hash index of record numbers with linear
+// probing. Both are sized when the file is created and never move, so the
+// file can be mapped once and used lock-free: a writer reserves a record
+// with an atomic add, fills it, publishes it, then claims an index slot
+// with a CAS. Readers only trust published records. Pages are loaded
+// lazily by the kernel as lookups touch them. When the record array is
+// full, new values are simply not cached.
+class PersistentCache {
+public:
+    struct Stats {
+        std::uint64_t records;   // Records in the file (all processes)
+        std::uint64_t capacity;  // Maximum number of records
+        std::uint64_t hits;      // Lookups by this process that hit
+        std::uint64_t misses;    // Lookups by this process that missed
+        size_t bytes;            // Size of the file
+    };
+
+    // Opens path, creating it with room for capacity records (rounded up to
+    // a power of two) if it does not exist. An existing file keeps the
+    // capacity it was created with and capacity is then ignored; once it is
+    // full, insert() silently drops new entries, which then cost a real
+    // evaluation every time. Delete the file to start over with a larger one.
+    explicit PersistentCache(const std::string& path, std::uint64_t capacity = 1 << 20) {
+        fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd < 0)
+            throw std::runtime_error("Cannot open persistent cache " + path);
+
+        // Only one process initialises a new file
+        ::flock(fd, LOCK_EX);
+        struct stat st;
+        ::fstat(fd, &st);
+        if (st.st_size == 0) {
+            std::uint64_t records = roundUpPow2(capacity);
+            mappedSize = fileSize(records);
+            if (::ftruncate(fd, static_cast<off_t>(mappedSize)) != 0) {
+                ::flock(fd, LOCK_UN);
+                ::close(fd);
+                throw std::runtime_error("Cannot size persistent cache " + path);
+            }
+            map();
+            header->capacity = records;
+            header->indexMask = 2 * records - 1;
+            header->count.store(0);
+            header->magic = magicNumber;  // Written last: marks the file as initialised
+        } else {
+            mappedSize = static_cast<size_t>(st.st_size);
+            map();
+            if (header->magic != magicNumber || fileSize(header->capacity) != mappedSize) {
+                ::flock(fd, LOCK_UN);
+                unmap();
+                throw std::runtime_error("Not a persistent cache file: " + path);
+            }
+        }
+        ::flock(fd, LOCK_UN);
+    }
+
+    ~PersistentCache() { unmap(); }
+
+    PersistentCache(const PersistentCache&) = delete;
+    PersistentCache& operator=(const PersistentCache&) = delete;
+
+    // Stable 64-bit id for a function name (FNV-1a)
+    static std::uint64_t functionId(const std::string& name) {
+        std::uint64_t h = 0xcbf29ce484222325ULL;
+        for (unsigned char c : name) {
+            h ^= c;
+            h *= 0x100000001b3ULL;
+        }
+        return h;
+    }
+
+    bool find(std::uint64_t function, double x, double& value) {
+        std::uint64_t bits = cacheKey(x, CacheKeyMode::ExactBits, 0.0);
+        for (std::uint64_t slot = hash(function, bits) & header->indexMask;;
+             slot = (slot + 1) & header->indexMask) {
+            std::uint64_t entry = index[slot].load(std::memory_order_acquire);
+            if (entry == 0)
+                break;
+            const Record& r = records[entry - 1];
+            if (r.published.load(std::memory_order_acquire) && r.function == function && r.xbits == bits) {
+                value = r.value;
+                hits.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        misses.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    void insert(std::uint64_t function, double x, double value) {
+        std::uint64_t n = header->count.fetch_add(1, std::memory_order_relaxed);
+        if (n >= header->capacity) {
+            header->count.fetch_sub(1, std::memory_order_relaxed);
+            return;
+        }
+        std::uint64_t bits = cacheKey(x, CacheKeyMode::ExactBits, 0.0);
+        Record& r = records[n];
+        r.function = function;
+        r.xbits = bits;
+        r.value = value;
+        r.published.store(1, std::memory_order_release);
+
+        // The index has twice as many slots as records, so a free one exists
+        for (std::uint64_t slot = hash(function, bits) & header->indexMask;;
+             slot = (slot + 1) & header->indexMask) {
+            std::uint64_t expected = 0;
+            if (index[slot].compare_exchange_strong(expected, n + 1, std::memory_order_acq_rel))
+                return;
+            const Record& other = records[expected - 1];
+            // Another writer got there first; the duplicate record stays unindexed
+            if (other.published.load(std::memory_order_acquire) && other.function == function &&
+                other.xbits == bits)
+                return;
+        }
+    }
+
+    Stats stats() const {
+        std::uint64_t n = std::min(header->count.load(std::memory_order_relaxed), header->capacity);
+        return Stats{n, header->capacity, hits.load(), misses.load(), mappedSize};
+    }
+
+private:
+    static const std::uint64_t magicNumber = 0x3130455643455650ULL;  // "PVECEV01"
+
+    struct Header {
+        std::uint64_t magic;
+        std::uint64_t capacity;
+        std::uint64_t indexMask;
+        std::atomic<std::uint64_t> count;
+        char padding[4096 - 4 * sizeof(std::uint64_t)];
+    };
+
+    struct Record {
+        std::uint64_t function;
+        std::uint64_t xbits;
+        double value;
+        std::atomic<std::uint64_t> published;
+    };
+
+    static std::uint64_t roundUpPow2(std::uint64_t n) {
+        std::uint64_t p = 1;
+        while (p < n)
+            p <<= 1;
+        return p;
+    }
+
+    static size_t fileSize(std::uint64_t records) {
+        return sizeof(Header) + records * sizeof(Record) + 2 * records * sizeof(std::uint64_t);
+    }
+
+    static std::uint64_t hash(std::uint64_t function, std::uint64_t bits) {
+        std::uint64_t h = function ^ (bits * 0x9e3779b97f4a7c15ULL);
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        return h;
+    }
+
+    void map() {
+        void* p = ::mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED) {
+            ::close(fd);
+            fd = -1;
+            throw std::runtime_error("Cannot map persistent cache");
+        }
+        base = static_cast<char*>(p);
+        header = reinterpret_cast<Header*>(base);
+        records = reinterpret_cast<Record*>(base + sizeof(Header));
+        std::uint64_t capacity = (mappedSize - sizeof(Header)) / (sizeof(Record) + 2 * sizeof(std::uint64_t));
+        index = reinterpret_cast<std::atomic<std::uint64_t>*>(base + sizeof(Header) + capacity * sizeof(Record));
+    }
+
+    void unmap() {
+        if (base)
+            ::munmap(base, mappedSize);
+        if (fd >= 0)
+            ::close(fd);
+        base = nullptr;
+        fd = -1;
+    }
+
+    int fd = -1;
+    size_t mappedSize = 0;
+    char* base = nullptr;
+    Header* header = nullptr;
+    Record* records = nullptr;
+    std::atomic<std::uint64_t>* index = nullptr;
+    std::atomic<std::uint64_t> hits{0};
+    std::atomic<std::uint64_t> misses{0};
+};
+
+// Function wrapper that looks x up in a PersistentCache under the given
+// function name before evaluating; the name must identify the integrand
+class PersistentCachedFunction : public Function {
+private:
+    MathFunction func_;
+    PersistentCache& cache_;
+    std::uint64_t id_;
+
+public:
+    PersistentCachedFunction(MathFunction func, const std::string& name, PersistentCache& cache)
+        : func_(func), cache_(cache), id_(PersistentCache::functionId(name)) {
+        uses_cache = true;
+    }
+
+    double operator()(double x) const override {
+        double value;
+        if (cache_.find(id_, x, value))
+            return value;
+        value = func_(x);
+        count++;
+        cache_.insert(id_, x, value);
+        return value;
+    }
+};
+
+#endif // PERSISTENT_CACHE_H
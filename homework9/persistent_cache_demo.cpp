@@ -0,0 +1,36 @@
+// persistent_cache_demo.cpp
+// Integrates the expensive integrands f5-f7 through a PersistentCache.
+// Run it twice: the second run (or a concurrent one) finds the points the
+// first one evaluated in the file and skips them.
+#include "complicated_functions.h"
+#include "integration_methods.h"
+#include "persistent_cache.h"
+#include <chrono>
+#include <iostream>
+
+int main(int argc, char** argv) {
+    std::string path = argc > 1 ? argv[1] : "evaluations.cache";
+    PersistentCache cache(path);
+
+    struct Case {
+        const char* name;
+        double (*f)(double);
+    };
+    const Case cases[] = {{"f5", f5}, {"f6", f6}, {"f7", f7}};
+
+    std::cout.precision(15);
+    for (const Case& c : cases) {
+        PersistentCachedFunction cached(c.f, c.name, cache);
+        auto start = std::chrono::high_resolution_clock::now();
+        AdaptiveResult r = adaptiveIntegrate(std::cref(cached), 0.0, 1.0, 1e-8, 12, AdaptiveRule::Simpson,
+                                             TolerancePolicy::HalvePerLevel);
+        auto end = std::chrono::high_resolution_clock::now();
+        std::cout << c.name << " on [0, 1]: " << r.value << ", " << r.evaluations << " calls, " << cached.getCount()
+                  << " evaluated, " << std::chrono::duration<double>(end - start).count() << " s\n";
+    }
+
+    PersistentCache::Stats s = cache.stats();
+    std::cout << path << ": " << s.records << " / " << s.capacity << " records, " << s.bytes << " bytes, "
+              << s.hits << " hits, " << s.misses << " misses this run\n";
+    return 0;
+}
@@ -0,0 +1,51 @@
+// romberg.cpp
+// Nested trapezoid refinement with Romberg (Richardson) extrapolation.
+#include "integration_methods.h"
+#include <cmath>
+#include <vector>
+
+// Romberg integration on [a, b].
+// Level k is the trapezoid rule with 2^k intervals. It is built from level
+// k - 1 by evaluating only the 2^(k-1) new midpoints, so every node is
+// evaluated once no matter how many levels run. Each new trapezoid sum is
+// then extrapolated across the previous row of the Romberg tableau, and
+// the interval count keeps doubling until the diagonal entries of two
+// consecutive rows agree to within tol, or maxLevels is reached.
+RombergResult romberg(const MathFunction& f, double a, double b, double tol, int maxLevels) {
+    std::vector<double> previous, current;
+    current.push_back(0.5 * (b - a) * (f(a) + f(b)));
+    int evaluations = 2;
+
+    double error = std::abs(current[0]);
+    int level = 0;
+    bool converged = false;
+    while (level < maxLevels) {
+        ++level;
+        previous.swap(current);
+        current.assign(level + 1, 0.0);
+
+        // Only the midpoints of the previous level's intervals are new
+        long long newPoints = 1LL << (level - 1);
+        double h = (b - a) / static_cast<double>(2 * newPoints);
+        double midpointSum = 0.0;
+        for (long long i = 0; i < newPoints; ++i)
+            midpointSum += f(a + static_cast<double>(2 * i + 1) * h);
+        evaluations += static_cast<int>(newPoints);
+        current[0] = 0.5 * previous[0] + h * midpointSum;
+
+        // Richardson extrapolation: column j cancels the h^(2j) error term
+        double factor = 1.0;
+        for (int j = 1; j <= level; ++j) {
+            factor *= 4.0;
+            current[j] = current[j - 1] + (current[j - 1] - previous[j - 1]) / (factor - 1.0);
+        }
+
+        error = std::abs(current[level] - previous[level - 1]);
+        if (level >= 2 && error <= tol) {
+            converged = true;
+            break;
+        }
+    }
+
+    return RombergResult{current[level], current[0], error, evaluations, level, converged};
+}
@@ -0,0 +1,202 @@
+#ifndef STATIC_INTEGRATION_H
+#define STATIC_INTEGRATION_H
+
+#include <algorithm>
+#include <cmath>
+#include "accumulation.h"
+
+// Integrators templated on the callable type. The integrand is called
+// directly instead of through std::function or a virtual operator(), so a
+// lambda or function object is inlined into the loop. Rule nodes and
+// weights are constexpr and the per-panel sum is unrolled at compile time.
+// The composite rules also take an accumulation policy (accumulation.h) for
+// the sum over panels; panel values are handed to it in blocks.
+//
+// The runtime MathFunction entry points in integration_methods.cpp and the
+// Integration classes in main.cpp instantiate these templates.
+
+// Closed Newton-Cotes rules. A panel spans panelWidth subintervals of width
+// h; node(i) is in units of h from the start of the panel and weight(i) is
+// the weight of that node times 1/h. Endpoint weights are equal, so a node
+// shared by two panels gets twice the endpoint weight.
+struct TrapezoidRule {
+    static constexpr int points = 2;
+    static constexpr int panelWidth = 1;
+    static constexpr double node(int i) { return i; }
+    static constexpr double weight(int) { return 0.5; }
+};
+
+struct SimpsonRule {
+    static constexpr int points = 3;
+    static constexpr int panelWidth = 2;
+    static constexpr double node(int i) { return i; }
+    static constexpr double weight(int i) { return i == 1 ? 4.0 / 3.0 : 1.0 / 3.0; }
+};
+
+// Gauss-Legendre rules on [-1, 1]
+namespace static_integration_detail {
+constexpr double gauss2Nodes[] = {-0.57735026918962576451, 0.57735026918962576451};
+constexpr double gauss2Weights[] = {1.0, 1.0};
+constexpr double gauss3Nodes[] = {-0.77459666924148337704, 0.0, 0.77459666924148337704};
+constexpr double gauss3Weights[] = {5.0 / 9.0, 8.0 / 9.0, 5.0 / 9.0};
+constexpr double gauss4Nodes[] = {-0.86113631159405257522, -0.33998104358485626480, 0.33998104358485626480,
+                                  0.86113631159405257522};
+constexpr double gauss4Weights[] = {0.34785484513745385737, 0.65214515486254614263, 0.65214515486254614263,
+                                    0.34785484513745385737};
+constexpr double gauss5Nodes[] = {-0.90617984593866399280, -0.53846931010568309104, 0.0, 0.53846931010568309104,
+                                  0.90617984593866399280};
+constexpr double gauss5Weights[] = {0.23692688505618908751, 0.47862867049936646804, 0.56888888888888888889,
+                                    0.47862867049936646804, 0.23692688505618908751};
+}  // namespace static_integration_detail
+
+template<int N>
+struct GaussLegendreRule;
+
+#define GAUSS_LEGENDRE_RULE(N)                                                                      \
+    template<>                                                                                      \
+    struct GaussLegendreRule<N> {                                                                   \
+        static constexpr int points = N;                                                            \
+        static constexpr double node(int i) { return static_integration_detail::gauss##N##Nodes[i]; }     \
+        static constexpr double weight(int i) { return static_integration_detail::gauss##N##Weights[i]; } \
+    };
+GAUSS_LEGENDRE_RULE(2)
+GAUSS_LEGENDRE_RULE(3)
+GAUSS_LEGENDRE_RULE(4)
+GAUSS_LEGENDRE_RULE(5)
+#undef GAUSS_LEGENDRE_RULE
+
+// Compile-time check of the tables: an N-point Gauss rule integrates x^k
+// exactly on [-1, 1] for every k <= 2N - 1
+namespace static_integration_detail {
+constexpr double magnitude(double x) { return x < 0 ? -x : x; }
+constexpr double power(double x, int k) { return k == 0 ? 1.0 : x * power(x, k - 1); }
+
+// sum of weight(i) * node(i)^k for i in [i, points)
+template<class Rule>
+constexpr double moment(int k, int i = 0) {
+    return i == Rule::points ? 0.0 : Rule::weight(i) * power(Rule::node(i), k) + moment<Rule>(k, i + 1);
+}
+
+template<class Rule>
+constexpr bool exactUpTo(int k) {
+    return k < 0 || (magnitude(moment<Rule>(k) - (k % 2 ? 0.0 : 2.0 / (k + 1))) <= 1e-15 && exactUpTo<Rule>(k - 1));
+}
+}  // namespace static_integration_detail
+
+static_assert(static_integration_detail::exactUpTo<GaussLegendreRule<2>>(3), "Gauss-Legendre 2 table is wrong");
+static_assert(static_integration_detail::exactUpTo<GaussLegendreRule<3>>(5), "Gauss-Legendre 3 table is wrong");
+static_assert(static_integration_detail::exactUpTo<GaussLegendreRule<4>>(7), "Gauss-Legendre 4 table is wrong");
+static_assert(static_integration_detail::exactUpTo<GaussLegendreRule<5>>(9), "Gauss-Legendre 5 table is wrong");
+
+namespace static_integration_detail {
+// sum of weight(i) * f(offset + scale * node(i)) for i in [I, End), unrolled
+template<class Rule, int I, int End>
+struct RuleSum {
+    template<class F>
+    static double apply(F& f, double offset, double scale) {
+        return Rule::weight(I) * f(offset + scale * Rule::node(I)) +
+               RuleSum<Rule, I + 1, End>::apply(f, offset, scale);
+    }
+};
+
+template<class Rule, int End>
+struct RuleSum<Rule, End, End> {
+    template<class F>
+    static double apply(F&, double, double) { return 0.0; }
+};
+
+// Panels per block handed to an accumulation policy
+const int accumulationBlock = 64;
+
+struct AdaptiveSum {
+    double value;
+    int evaluations;
+    int truncatedIntervals;
+};
+
+// One step of adaptive Simpson; visits intervals depth first, left half
+// first, and accumulates in that order like adaptiveIntegrate
+template<class F>
+void adaptiveSimpsonStep(F& f, double a, double b, double fa, double fm, double fb, double area, double tol,
+                         int depth, int maxDepth, AdaptiveSum& sum) {
+    if (depth >= maxDepth) {
+        sum.value += area;
+        ++sum.truncatedIntervals;
+        return;
+    }
+    double c = (a + b) / 2;
+    double flm = f((a + c) / 2);
+    double frm = f((c + b) / 2);
+    sum.evaluations += 2;
+    double left = (c - a) * (fa + 4 * flm + fm) / 6;
+    double right = (b - c) * (fm + 4 * frm + fb) / 6;
+    if (std::abs(left + right - area) < tol) {
+        sum.value += left + right;
+        return;
+    }
+    adaptiveSimpsonStep(f, a, c, fa, flm, fm, left, tol / 2, depth + 1, maxDepth, sum);
+    adaptiveSimpsonStep(f, c, b, fm, frm, fb, right, tol / 2, depth + 1, maxDepth, sum);
+}
+}  // namespace static_integration_detail
+
+// Composite closed rule on n subintervals, rounded up to a whole number of
+// panels. Every grid node is evaluated once. With NaiveSum the terms are
+// added in panel order, as a plain loop would.
+template<class Rule, class Accumulation = NaiveSum, class F>
+double compositeClosed(F&& f, double a, double b, int n) {
+    using static_integration_detail::accumulationBlock;
+    const int width = Rule::panelWidth;
+    const int panels = (n + width - 1) / width;
+    n = panels * width;
+    double h = (b - a) / n;
+
+    double ends = f(a) + f(b);
+    Accumulation junctions, interior;
+    double junctionBlock[accumulationBlock], interiorBlock[accumulationBlock];
+    for (int start = 0; start < panels; start += accumulationBlock) {
+        int count = std::min(accumulationBlock, panels - start);
+        for (int k = 0; k < count; ++k) {
+            int p = start + k;
+            double x0 = a + p * width * h;
+            junctionBlock[k] = p > 0 ? f(x0) : 0.0;
+            interiorBlock[k] = static_integration_detail::RuleSum<Rule, 1, Rule::points - 1>::apply(f, x0, h);
+        }
+        junctions.add(junctionBlock, count);
+        interior.add(interiorBlock, count);
+    }
+    return h * (Rule::weight(0) * (ends + 2 * junctions.value()) + interior.value());
+}
+
+// Composite Gauss rule on panels equal subintervals
+template<class Rule, class Accumulation = NaiveSum, class F>
+double compositeGauss(F&& f, double a, double b, int panels) {
+    using static_integration_detail::accumulationBlock;
+    double h = (b - a) / panels;
+    Accumulation sum;
+    double panelBlock[accumulationBlock];
+    for (int start = 0; start < panels; start += accumulationBlock) {
+        int count = std::min(accumulationBlock, panels - start);
+        for (int k = 0; k < count; ++k) {
+            double mid = a + (start + k + 0.5) * h;
+            panelBlock[k] = static_integration_detail::RuleSum<Rule, 0, Rule::points>::apply(f, mid, h / 2);
+        }
+        sum.add(panelBlock, count);
+    }
+    return sum.value() * h / 2;
+}
+
+// Adaptive Simpson with the tolerance halved per level; takes the same
+// decisions and returns the same value as adaptiveIntegrate with
+// AdaptiveRule::Simpson and TolerancePolicy::HalvePerLevel
+template<class F>
+double adaptiveSimpsonStatic(F&& f, double a, double b, double tol, int maxDepth, int* evaluations = nullptr) {
+    double fa = f(a), fb = f(b), fm = f((a + b) / 2);
+    double area = (b - a) * (fa + 4 * fm + fb) / 6;
+    static_integration_detail::AdaptiveSum sum{0.0, 3, 0};
+    static_integration_detail::adaptiveSimpsonStep(f, a, b, fa, fm, fb, area, tol, 0, maxDepth, sum);
+    if (evaluations)
+        *evaluations = sum.evaluations;
+    return sum.value;
+}
+
+#endif // STATIC_INTEGRATION_H
@@ -0,0 +1,72 @@
+// summation_demo.cpp
+// Rounding error and cost of the accumulation policies on long composite
+// sums whose discretisation error vanishes, so what remains is rounding:
+// trapezoid on x^3 - 3x^2 + 2 over [0, 2] (the homework10 part4 integrand,
+// exact for the trapezoid rule) and Simpson on sin over [0, pi] with
+// enough nodes that h^4 is far below eps.
+#include "static_integration.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// long double accumulator, for comparison only
+struct LongDoubleSum {
+    long double sum = 0.0L;
+
+    void add(double v) { sum += v; }
+    void add(const double* values, int count) {
+        for (int i = 0; i < count; ++i)
+            sum += values[i];
+    }
+    double value() const { return static_cast<double>(sum); }
+};
+
+// Best of three runs in nanoseconds. The lower bound is read from and the
+// result written to volatiles inside the timed region, so the (pure)
+// integration cannot be moved out of it or shared between trials.
+template<class Rule, class Accumulation, class F>
+double timeRule(F f, double a, double b, int n, double& result) {
+    volatile double lower = a, sink;
+    double best = 1e300;
+    for (int trial = 0; trial < 3; ++trial) {
+        auto start = std::chrono::high_resolution_clock::now();
+        sink = compositeClosed<Rule, Accumulation>(f, lower, b, n);
+        auto end = std::chrono::high_resolution_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::nano>(end - start).count());
+    }
+    result = sink;
+    return best;
+}
+
+template<class Rule, class Accumulation, class F>
+void run(const char* name, F f, double a, double b, int n, double exact) {
+    double result;
+    double best = timeRule<Rule, Accumulation>(f, a, b, n, result);
+    std::cout << "    " << name << ": error " << std::abs(result - exact) << ", " << best / (n + 1) << " ns per node\n";
+}
+
+template<class Rule, class F>
+void compare(const char* title, F f, double a, double b, double exact) {
+    for (int n : {1000000, 10000000}) {
+        std::cout << "  " << title << ", n = " << n << ":\n";
+        run<Rule, NaiveSum>("naive        ", f, a, b, n, exact);
+        run<Rule, NeumaierSum>("Neumaier     ", f, a, b, n, exact);
+        run<Rule, PairwiseSum>("pairwise     ", f, a, b, n, exact);
+        run<Rule, DoubleDoubleSum>("double-double", f, a, b, n, exact);
+        run<Rule, LongDoubleSum>("long double  ", f, a, b, n, exact);
+    }
+}
+
+int main() {
+    std::cout.precision(4);
+    std::cout << "Rounding error by accumulation policy:\n";
+    compare<TrapezoidRule>("trapezoid, x^3 - 3x^2 + 2 on [0, 2]",
+                           [](double x) { return x * x * x - 3 * x * x + 2; }, 0.0, 2.0, 0.0);
+    compare<SimpsonRule>("Simpson, sin(x) on [0, pi]", [](double x) { return std::sin(x); }, 0.0, M_PI, 2.0);
+    return 0;
+}
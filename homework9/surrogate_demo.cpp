@@ -0,0 +1,78 @@
+// surrogate_demo.cpp
+// Integrates expensive integrands over many subranges of [0, 1]: once per
+// subrange with adaptive Simpson (tol 1e-10, depth 20), and from a
+// piecewise Chebyshev surrogate that is fitted once.
+#include "chebyshev_surrogate.h"
+#include "complicated_functions.h"
+#include "integration_methods.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <thread>
+
+int main() {
+    struct Case {
+        const char* name;
+        double (*f)(double);
+    };
+    const Case cases[] = {{"f1", f1}, {"f4", f4}, {"f7", f7}};
+    const int queries = 2000;
+
+    // The same subranges for every integrand
+    std::mt19937_64 rng(5305);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::vector<std::pair<double, double>> ranges(queries);
+    for (auto& range : ranges) {
+        double x0 = uniform(rng), x1 = uniform(rng);
+        range = std::make_pair(std::min(x0, x1), std::max(x0, x1));
+    }
+
+    SurrogateOptions options;
+    options.numThreads = std::max(1u, std::thread::hardware_concurrency());
+
+    std::cout.precision(6);
+    for (const Case& c : cases) {
+        auto start = std::chrono::high_resolution_clock::now();
+        long long simpsonEvaluations = 0;
+        std::vector<double> direct(queries);
+        for (int i = 0; i < queries; ++i) {
+            AdaptiveResult r = adaptiveIntegrate(c.f, ranges[i].first, ranges[i].second, 1e-10, 20,
+                                                 AdaptiveRule::Simpson, TolerancePolicy::HalvePerLevel);
+            direct[i] = r.value;
+            simpsonEvaluations += r.evaluations;
+        }
+        auto middle = std::chrono::high_resolution_clock::now();
+        ChebyshevSurrogate surrogate(c.f, 0.0, 1.0, options);
+        auto built = std::chrono::high_resolution_clock::now();
+        std::vector<double> fromSurrogate(queries);
+        for (int i = 0; i < queries; ++i)
+            fromSurrogate[i] = surrogate.integral(ranges[i].first, ranges[i].second);
+        auto end = std::chrono::high_resolution_clock::now();
+
+        // Accuracy against a tight reference on a sample of the subranges
+        double simpsonError = 0.0, surrogateError = 0.0;
+        for (int i = 0; i < queries; i += 10) {
+            double reference = gaussKronrodAdaptive(c.f, ranges[i].first, ranges[i].second, 1e-13, 10000,
+                                                    GaussKronrodRule::G10K21).value;
+            simpsonError = std::max(simpsonError, std::abs(direct[i] - reference));
+            surrogateError = std::max(surrogateError, std::abs(fromSurrogate[i] - reference));
+        }
+
+        // Value and derivative at one point, derivative against a central difference
+        double x = 0.377, h = 1e-5;
+        double difference = (c.f(x + h) - c.f(x - h)) / (2 * h);
+
+        std::cout << c.name << ", " << queries << " subranges of [0, 1]:\n"
+                  << "  adaptive Simpson: " << simpsonEvaluations << " evaluations, "
+                  << std::chrono::duration<double>(middle - start).count() << " s, max error " << simpsonError << "\n"
+                  << "  surrogate: " << surrogate.pieces() << " pieces from " << surrogate.evaluations()
+                  << " evaluations" << (surrogate.converged() ? "" : " (not converged)") << ", built in "
+                  << std::chrono::duration<double>(built - middle).count() << " s, queries "
+                  << std::chrono::duration<double>(end - built).count() << " s, max error " << surrogateError << "\n"
+                  << "  at x = " << x << ": value error " << std::abs(surrogate.value(x) - c.f(x))
+                  << ", derivative " << surrogate.derivative(x) << " vs central difference " << difference << "\n";
+    }
+    return 0;
+}
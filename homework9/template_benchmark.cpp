@@ -0,0 +1,89 @@
+// template_benchmark.cpp
+// Cost of calling a cheap integrand through a virtual Function wrapping a
+// std::function (two indirect calls), through std::function alone, and
+// through a template parameter that the compiler can inline.
+#include "definitions.h"
+#include "integration_methods.h"
+#include "static_integration.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// Uncached Function: virtual operator() forwarding to a std::function
+class PlainFunction : public Function {
+private:
+    MathFunction func_;
+
+public:
+    explicit PlainFunction(MathFunction func) : func_(func) {}
+    double operator()(double x) const override { return func_(x); }
+};
+
+// Best of several runs, in nanoseconds per evaluation
+template<class Run>
+double timePerEvaluation(Run run, long evaluations, double& result) {
+    double best = 1e300;
+    for (int trial = 0; trial < 5; ++trial) {
+        auto start = std::chrono::high_resolution_clock::now();
+        result = run();
+        auto end = std::chrono::high_resolution_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::nano>(end - start).count());
+    }
+    return best / evaluations;
+}
+
+template<class Lambda>
+void compare(const char* name, Lambda f, double a, double b, double exact) {
+    const int n = 1 << 20;
+    MathFunction wrapped = f;
+    PlainFunction virtualF(wrapped);
+    const Function& base = virtualF;
+    double r1, r2, r3;
+
+    std::cout << name << " on [" << a << ", " << b << "], " << n << " intervals (ns per evaluation):\n";
+
+    double t1 = timePerEvaluation([&]() { return compositeClosed<TrapezoidRule>(base, a, b, n); }, n + 1, r1);
+    double t2 = timePerEvaluation([&]() { return trapezoidalNonRecursive(wrapped, a, b, n); }, n + 1, r2);
+    double t3 = timePerEvaluation([&]() { return compositeClosed<TrapezoidRule>(f, a, b, n); }, n + 1, r3);
+    std::cout << "  Trapezoid:  virtual+std::function " << t1 << ", std::function " << t2 << ", template " << t3
+              << " (error " << std::abs(r3 - exact) << ")\n";
+
+    t1 = timePerEvaluation([&]() { return compositeClosed<SimpsonRule>(base, a, b, n); }, n + 1, r1);
+    t2 = timePerEvaluation([&]() { return simpsonNonRecursive(wrapped, a, b, n); }, n + 1, r2);
+    t3 = timePerEvaluation([&]() { return compositeClosed<SimpsonRule>(f, a, b, n); }, n + 1, r3);
+    std::cout << "  Simpson:    virtual+std::function " << t1 << ", std::function " << t2 << ", template " << t3
+              << " (error " << std::abs(r3 - exact) << ")\n";
+
+    const int panels = n / 5;
+    t1 = timePerEvaluation([&]() { return compositeGauss<GaussLegendreRule<5>>(base, a, b, panels); }, 5L * panels, r1);
+    t2 = timePerEvaluation([&]() { return compositeGauss<GaussLegendreRule<5>>(wrapped, a, b, panels); }, 5L * panels, r2);
+    t3 = timePerEvaluation([&]() { return compositeGauss<GaussLegendreRule<5>>(f, a, b, panels); }, 5L * panels, r3);
+    std::cout << "  Gauss 5:    virtual+std::function " << t1 << ", std::function " << t2 << ", template " << t3
+              << " (error " << std::abs(r3 - exact) << ")\n";
+
+    // The adaptive template must take the same path as the runtime engine
+    int evaluations = 0;
+    AdaptiveResult engine = adaptiveIntegrate(wrapped, a, b, 1e-13, 30, AdaptiveRule::Simpson,
+                                              TolerancePolicy::HalvePerLevel);
+    t2 = timePerEvaluation([&]() {
+        return adaptiveIntegrate(wrapped, a, b, 1e-13, 30, AdaptiveRule::Simpson, TolerancePolicy::HalvePerLevel).value;
+    }, engine.evaluations, r2);
+    t3 = timePerEvaluation([&]() { return adaptiveSimpsonStatic(f, a, b, 1e-13, 30, &evaluations); },
+                           engine.evaluations, r3);
+    std::cout << "  Adaptive Simpson (" << engine.evaluations << " evaluations): engine " << t2 << ", template " << t3
+              << ", identical result: "
+              << (std::memcmp(&r2, &r3, sizeof(double)) == 0 && evaluations == engine.evaluations ? "yes" : "no")
+              << "\n";
+}
+
+int main() {
+    compare("sin(x)", [](double x) { return std::sin(x); }, 0.0, M_PI, 2.0);
+    compare("x^3 - x", [](double x) { return x * x * x - x; }, 0.0, 2.0, 2.0);
+    return 0;
+}
@@ -0,0 +1,193 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Structured tracing that stays cheap enough to leave enabled.
+//
+// TRACE(level, event, x, value) records a fixed-size event into a ring
+// owned by the calling thread: no lock, no allocation, no I/O. A background
+// thread drains all rings into a CSV file. A full ring drops the event (and
+// counts it) instead of blocking the hot path.
+//
+// Levels above TRACE_MAX_LEVEL compile to nothing; the runtime level is
+// set by Tracer::open() and checked with one relaxed load.
+
+enum class TraceLevel : int { Off = 0, Error = 1, Info = 2, Debug = 3 };
+
+#ifndef TRACE_MAX_LEVEL
+#define TRACE_MAX_LEVEL 3
+#endif
+
+struct TraceEvent {
+    std::uint64_t nanoseconds;  // Since the tracer was opened
+    const char* name;           // Must be a string literal
+    double x;
+    double value;
+    TraceLevel level;
+};
+
+// Single-producer single-consumer ring: the owning thread pushes, the
+// flusher thread pops
+class TraceRing {
+public:
+    static const size_t capacity = 1 << 16;
+
+    explicit TraceRing(std::uint32_t threadId) : threadId(threadId) {}
+
+    // Returns the number of queued events after the push (0 if dropped)
+    size_t push(const TraceEvent& e) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        size_t queued = head - tail_.load(std::memory_order_acquire);
+        if (queued == capacity) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return 0;
+        }
+        events[head & (capacity - 1)] = e;
+        head_.store(head + 1, std::memory_order_release);
+        return queued + 1;
+    }
+
+    template<class F>
+    void drain(F sink) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        size_t head = head_.load(std::memory_order_acquire);
+        for (; tail != head; ++tail)
+            sink(events[tail & (capacity - 1)]);
+        tail_.store(tail, std::memory_order_release);
+    }
+
+    const std::uint32_t threadId;
+    std::atomic<std::uint64_t> dropped{0};
+
+private:
+    TraceEvent events[capacity];
+    std::atomic<size_t> head_{0};
+    char padding[64];  // Producer and consumer indices on separate cache lines
+    std::atomic<size_t> tail_{0};
+};
+
+class Tracer {
+public:
+    static Tracer& instance() {
+        static Tracer tracer;
+        return tracer;
+    }
+
+    // Starts tracing up to level into path, flushed every flushInterval
+    void open(const std::string& path, TraceLevel level,
+              std::chrono::milliseconds flushInterval = std::chrono::milliseconds(50)) {
+        close();
+        std::lock_guard<std::mutex> lock(mutex);
+        out.open(path);
+        out << "thread,nanoseconds,level,event,x,value\n";
+        out.precision(17);
+        start = std::chrono::steady_clock::now();
+        interval = flushInterval;
+        stopping = false;
+        flusher = std::thread(&Tracer::flushLoop, this);
+        currentLevel.store(static_cast<int>(level), std::memory_order_relaxed);
+    }
+
+    // Stops tracing, drains every ring and closes the file
+    void close() {
+        currentLevel.store(static_cast<int>(TraceLevel::Off), std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!flusher.joinable())
+                return;
+            stopping = true;
+        }
+        wake.notify_one();
+        flusher.join();
+        std::lock_guard<std::mutex> lock(mutex);
+        drainAll();
+        out.close();
+    }
+
+    bool enabled(TraceLevel level) const {
+        return static_cast<int>(level) <= currentLevel.load(std::memory_order_relaxed);
+    }
+
+    void record(TraceLevel level, const char* name, double x, double value) {
+        std::uint64_t ns = static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+        // Wake the flusher early once a ring is half full
+        if (threadRing().push(TraceEvent{ns, name, x, value, level}) == TraceRing::capacity / 2)
+            wake.notify_one();
+    }
+
+    // Events lost to full rings since the process started
+    std::uint64_t droppedEvents() {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::uint64_t n = 0;
+        for (auto& ring : rings)
+            n += ring->dropped.load(std::memory_order_relaxed);
+        return n;
+    }
+
+    ~Tracer() { close(); }
+
+private:
+    Tracer() = default;
+
+    // Rings are registered once per thread and owned by the tracer, so
+    // events of threads that already exited are still flushed
+    TraceRing& threadRing() {
+        static thread_local TraceRing* ring = nullptr;
+        if (!ring) {
+            std::lock_guard<std::mutex> lock(mutex);
+            rings.emplace_back(new TraceRing(static_cast<std::uint32_t>(rings.size())));
+            ring = rings.back().get();
+        }
+        return *ring;
+    }
+
+    void flushLoop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!stopping) {
+            wake.wait_for(lock, interval);
+            drainAll();
+        }
+    }
+
+    // Called with mutex held
+    void drainAll() {
+        static const char* levelNames[] = {"off", "error", "info", "debug"};
+        for (auto& ring : rings) {
+            std::uint32_t id = ring->threadId;
+            ring->drain([&](const TraceEvent& e) {
+                out << id << ',' << e.nanoseconds << ',' << levelNames[static_cast<int>(e.level)] << ','
+                    << e.name << ',' << e.x << ',' << e.value << '\n';
+            });
+        }
+        out.flush();
+    }
+
+    std::atomic<int> currentLevel{static_cast<int>(TraceLevel::Off)};
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::vector<std::unique_ptr<TraceRing>> rings;
+    std::thread flusher;
+    std::ofstream out;
+    std::chrono::steady_clock::time_point start;
+    std::chrono::milliseconds interval{50};
+    bool stopping = false;
+};
+
+#define TRACE(level, name, x, value)                                                   \
+    do {                                                                               \
+        if (static_cast<int>(level) <= TRACE_MAX_LEVEL && Tracer::instance().enabled(level)) \
+            Tracer::instance().record(level, name, x, value);                          \
+    } while (0)
+
+#endif // TRACE_H
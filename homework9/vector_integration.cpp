@@ -0,0 +1,133 @@
+// vector_integration.cpp
+// Adaptive trapezoid and Simpson for vector-valued integrands: one
+// refinement tree and one set of nodes shared by every component.
+#include "integration_methods.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Same traversal as adaptiveIntegrate: depth first, left half first, each
+// interval carrying the values its parent computed. A stack slot holds the
+// interval's bounds, tolerance and depth, and a block of 4 * components
+// values laid out as [fa | fb | fm | area]. With one component the result is
+// bit-identical to adaptiveIntegrate.
+VectorAdaptiveResult adaptiveIntegrateVector(const VectorFunction& f, int components, double a, double b,
+                                             double tol, int maxDepth, AdaptiveRule rule, TolerancePolicy policy) {
+    const int n = std::max(components, 0);
+    const bool simpson = (rule == AdaptiveRule::Simpson);
+    const double richardson = simpson ? 15.0 : 3.0;
+    VectorAdaptiveResult result{std::vector<double>(n, 0.0), std::vector<double>(n, 0.0), 0, 0, 0};
+    if (n == 0)
+        return result;
+
+    // Children are only pushed below maxDepth, so the stack never holds more
+    // than maxDepth + 1 intervals
+    const size_t slots = static_cast<size_t>(std::max(maxDepth, 0)) + 1;
+    const size_t stride = 4 * static_cast<size_t>(n);
+    std::vector<double> lo(slots), hi(slots), tols(slots);
+    std::vector<int> depths(slots);
+    std::vector<double> block(slots * stride, 0.0);
+
+    // The popped parent, the new samples and the child areas
+    std::vector<double> scratch(8 * static_cast<size_t>(n), 0.0);
+    double* pfa = scratch.data();
+    double* pfb = pfa + n;
+    double* pfm = pfb + n;
+    double* parea = pfm + n;
+    double* s1 = parea + n;  // Left quarter point (Simpson) or midpoint (trapezoid)
+    double* s2 = s1 + n;     // Right quarter point (Simpson only)
+    double* leftArea = s2 + n;
+    double* rightArea = leftArea + n;
+
+    double* root = block.data();
+    f(a, root);
+    f(b, root + n);
+    if (simpson)
+        f((a + b) / 2, root + 2 * n);
+    result.evaluations = simpson ? 3 : 2;
+    for (int k = 0; k < n; ++k)
+        root[3 * n + k] = simpson ? (b - a) * (root[k] + 4 * root[2 * n + k] + root[n + k]) / 6
+                                  : 0.5 * (b - a) * (root[k] + root[n + k]);
+    lo[0] = a;
+    hi[0] = b;
+    tols[0] = tol;
+    depths[0] = 0;
+
+    size_t top = 1;
+    while (top > 0) {
+        --top;
+        const double x0 = lo[top], x1 = hi[top], inTol = tols[top];
+        const int depth = depths[top];
+        double* slot = block.data() + top * stride;
+        result.maxDepthReached = std::max(result.maxDepthReached, depth);
+
+        if (depth >= maxDepth) {
+            for (int k = 0; k < n; ++k)
+                result.values[k] += slot[3 * n + k];
+            ++result.truncatedIntervals;
+            continue;
+        }
+
+        // The right child reuses this slot, so keep the parent aside
+        std::copy(slot, slot + stride, pfa);
+
+        const double c = (x0 + x1) / 2;
+        if (simpson) {
+            f((x0 + c) / 2, s1);
+            f((c + x1) / 2, s2);
+            result.evaluations += 2;
+            for (int k = 0; k < n; ++k) {
+                leftArea[k] = (c - x0) * (pfa[k] + 4 * s1[k] + pfm[k]) / 6;
+                rightArea[k] = (x1 - c) * (pfm[k] + 4 * s2[k] + pfb[k]) / 6;
+            }
+        } else {
+            f(c, s1);
+            result.evaluations += 1;
+            for (int k = 0; k < n; ++k) {
+                leftArea[k] = 0.5 * (c - x0) * (pfa[k] + s1[k]);
+                rightArea[k] = 0.5 * (x1 - c) * (s1[k] + pfb[k]);
+            }
+        }
+
+        double largest = 0.0;
+        for (int k = 0; k < n; ++k)
+            largest = std::max(largest, std::abs(leftArea[k] + rightArea[k] - parea[k]));
+
+        if (largest < inTol) {
+            for (int k = 0; k < n; ++k) {
+                result.values[k] += leftArea[k] + rightArea[k];
+                result.errors[k] += std::abs(leftArea[k] + rightArea[k] - parea[k]) / richardson;
+            }
+            continue;
+        }
+        if (depth + 1 >= maxDepth) {
+            for (int k = 0; k < n; ++k)
+                result.errors[k] += std::abs(leftArea[k] + rightArea[k] - parea[k]) / richardson;
+        }
+
+        // Right half into the parent's slot, left half above it (popped first)
+        const double* mid = simpson ? pfm : s1;
+        const double childTol = (policy == TolerancePolicy::HalvePerLevel) ? inTol / 2 : inTol;
+        double* right = slot;
+        double* left = slot + stride;
+        for (int k = 0; k < n; ++k) {
+            right[k] = mid[k];
+            right[n + k] = pfb[k];
+            right[2 * n + k] = s2[k];
+            right[3 * n + k] = rightArea[k];
+            left[k] = pfa[k];
+            left[n + k] = mid[k];
+            left[2 * n + k] = s1[k];
+            left[3 * n + k] = leftArea[k];
+        }
+        lo[top] = c;
+        hi[top] = x1;
+        lo[top + 1] = x0;
+        hi[top + 1] = c;
+        tols[top] = tols[top + 1] = childTol;
+        depths[top] = depths[top + 1] = depth + 1;
+        top += 2;
+    }
+
+    return result;
+}
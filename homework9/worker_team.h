@@ -0,0 +1,111 @@
+#ifndef WORKER_TEAM_H
+#define WORKER_TEAM_H
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A fixed set of threads for one call of a round-based algorithm. The
+// helpers are started once and sleep between rounds; run(job) wakes them,
+// calls job(t) for every worker t in [0, size()) with worker 0 on the
+// calling thread, and returns when all of them are done. Rounds that run
+// many times per call (top-k refinement, surrogate fitting, Monte Carlo
+// batches) so pay for thread creation only once.
+class WorkerTeam {
+public:
+    explicit WorkerTeam(int numThreads) : workers(numThreads < 1 ? 1 : numThreads) {
+        for (int t = 1; t < workers; ++t)
+            helpers.emplace_back(&WorkerTeam::helperLoop, this, t);
+    }
+
+    ~WorkerTeam() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        start.notify_all();
+        for (std::thread& helper : helpers)
+            helper.join();
+    }
+
+    WorkerTeam(const WorkerTeam&) = delete;
+    WorkerTeam& operator=(const WorkerTeam&) = delete;
+
+    int size() const { return workers; }
+
+    // Runs job(t) on every worker; the first exception thrown by any of
+    // them is rethrown once the whole round has finished
+    void run(const std::function<void(int)>& job) {
+        if (workers == 1) {
+            job(0);
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            current = &job;
+            pending = workers - 1;
+            ++round;
+        }
+        start.notify_all();
+
+        std::exception_ptr error;
+        try {
+            job(0);
+        } catch (...) {
+            error = std::current_exception();
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait(lock, [this] { return pending == 0; });
+        current = nullptr;
+        if (!error)
+            error = helperError;
+        helperError = nullptr;
+        lock.unlock();
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+private:
+    void helperLoop(int t) {
+        unsigned long long seen = 0;
+        for (;;) {
+            const std::function<void(int)>* job;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                start.wait(lock, [&] { return stopping || round != seen; });
+                if (stopping)
+                    return;
+                seen = round;
+                job = current;
+            }
+            std::exception_ptr error;
+            try {
+                (*job)(t);
+            } catch (...) {
+                error = std::current_exception();
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            if (error && !helperError)
+                helperError = error;
+            if (--pending == 0)
+                finished.notify_one();
+        }
+    }
+
+    int workers;
+    std::vector<std::thread> helpers;
+    std::mutex mutex;
+    std::condition_variable start;
+    std::condition_variable finished;
+    const std::function<void(int)>* current = nullptr;
+    std::exception_ptr helperError;  // first exception of this round from a helper
+    unsigned long long round = 0;
+    int pending = 0;
+    bool stopping = false;
+};
+
+#endif